@@ -0,0 +1,1159 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "BenchmarkRunner.h"
+
+#include "CairoRoutines.h"
+#include "CairoScriptTrace.h"
+#include "CairoGLOffscreen.h"
+#include "CairoGLRoutines.h"
+#include "CairoImageRenderer.h"
+#include "CGRoutines.h"
+#include "ClockGrid.h"
+#include "D2DRoutines.h"
+#include "OffscreenTarget.h"
+#include "PixelOps.h"
+#include "ResultTable.h"
+#include "Timing.h"
+#include "WorkerPool.h"
+
+#include <shellapi.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#undef min
+#undef max
+
+BenchmarkOptions::BenchmarkOptions()
+   : renderer("cairo"), frames(1000), warmupFrames(10), width(400), height(400), phases(false), cairoFlags(0), displayList(false),
+   timeSource("fixed"), pacing("uncapped"), clocks(1), threads(0), pixelOps(false), frameCacheMB(0),
+   imageFormat("argb32"), imageStride(0), replayPasses(10),
+   startBarrier(0)
+{
+}
+
+BenchmarkResult::BenchmarkResult()
+   : frames(0), startTime(0.0), endTime(0.0), wallSeconds(0.0), cpuSeconds(0.0)
+{
+}
+
+static const struct
+{
+   const char* name;
+   unsigned flag;
+} cairoFlagNames[] =
+{
+   { "observe", e_CairoObserve },
+   { "tiles", e_CairoTiles },
+   { "layers", e_CairoLayers },
+   { "damage", e_CairoDamage },
+   { "batch", e_CairoBatch },
+   { "patterns", e_CairoPatterns },
+   { "atlas", e_CairoGlyphAtlas },
+   { "framecache", e_CairoFrameCache },
+   { "record", e_CairoRecord },
+   { "recordframe", e_CairoRecordFrame }
+};
+
+static const struct
+{
+   const char* name;
+   cairo_format_t format;
+} imageFormatNames[] =
+{
+   { "argb32", CAIRO_FORMAT_ARGB32 },
+   { "rgb24", CAIRO_FORMAT_RGB24 },
+   { "rgb16_565", CAIRO_FORMAT_RGB16_565 },
+   { "a8", CAIRO_FORMAT_A8 }
+};
+
+// From thumbnails to 8K, covering the common display resolutions.
+static const BenchmarkSize sizeLadder[] =
+{
+   { 64, 64 },
+   { 128, 128 },
+   { 256, 256 },
+   { 512, 512 },
+   { 1024, 768 },
+   { 1280, 720 },
+   { 1920, 1080 },
+   { 2560, 1440 },
+   { 3840, 2160 },
+   { 7680, 4320 }
+};
+
+// Scene complexities from the original single clock to a busy dashboard.
+static const unsigned clockLadder[] = { 1, 10, 100, 1000, 10000 };
+
+static void PrintBenchmarkUsage(FILE* out)
+{
+   fprintf(out,
+      "usage: D2Dtest /bench [options]\n"
+      "  /renderer <name>   cairo, cairoimage, cairogl, cairogloffscreen, d2d"
+#if !defined(NO_CORE_GRAPHICS)
+      ", cg"
+#endif
+      " (default cairo); a comma separated list for sweeps\n"
+      "  /frames <n>        frames to time (default 1000)\n"
+      "  /warmup <n>        untimed frames rendered first (default 10)\n"
+      "  /size <w>x<h>      offscreen target size (default 400x400)\n"
+      "  /sweep <sizes>     run at each of a comma separated list of sizes, or 'ladder' (64x64 to 7680x4320)\n"
+      "  /clocks <n>        draw a grid of n clocks per frame (default 1)\n"
+      "  /scene <counts>    run at each of a comma separated list of clock counts, or 'ladder' (1 to 10000)\n"
+      "  /threads <counts>  threads for parallel modes (default one per processor); a comma\n"
+      "                     separated list or 'ladder' (1, 2, 4, ... processors) sweeps them\n"
+      "  /instances <counts> render that many independent renderers on as many threads; a comma\n"
+      "                     separated list or 'ladder' (1, 2, 4, ... processors)\n"
+      "  /table <file>      also write the sweep table as CSV\n"
+      "  /histogram <file>  write the frame time histogram as JSON (or CSV if the name ends in .csv)\n"
+      "  /phases            break frame time down by drawing phase\n"
+      "  /pace <rate>       uncapped or a target rate in Hz such as 60 (default uncapped)\n"
+      "  /cachebudget <MB>  memory for '/cairo framecache' (default 64)\n"
+      "  /format <format>   pixel format of cairoimage: argb32, rgb24, rgb16_565 or a8 (default argb32)\n"
+      "  /stride <bytes>    row stride of cairoimage (default packed rows)\n"
+      "  /capture <file>    record the timed cairo frames into a cairo-script trace\n"
+#if !defined(NO_CAIRO_SCRIPT_INTERPRETER)
+      "  /replay <files>    time replaying comma separated cairo-script traces into image surfaces\n"
+      "  /passes <n>        timed passes over each '/replay' trace (default 10)\n"
+#endif
+      "  /pixelops          time the pixel kernels (GB/s per instruction set) at /size for /frames passes\n"
+      "  /displaylist       replay the scene from a retained display list\n"
+      "  /time <source>     wall, fixed[:<hh:mm:ss>[,<step>]] or script:<file> (default fixed)\n"
+      "  /cairo <flags>     comma separated cairo renderer modes:");
+
+   for (size_t i = 0; i < sizeof(cairoFlagNames) / sizeof(cairoFlagNames[0]); ++i)
+      fprintf(out, " %s", cairoFlagNames[i].name);
+   fprintf(out, "\n");
+}
+
+static bool IsOption(const std::string& arg, const char* name)
+{
+   if (arg.size() < 2 || (arg[0] != '/' && arg[0] != '-'))
+      return false;
+
+   return !strcmp(arg.c_str() + 1, name);
+}
+
+static bool ParseNonNegative(const std::string& text, int& value)
+{
+   char* end = 0;
+   long parsed = strtol(text.c_str(), &end, 10);
+   if (end == text.c_str() || *end || parsed < 0)
+      return false;
+
+   value = static_cast<int>(parsed);
+   return true;
+}
+
+static bool ParsePositive(const std::string& text, int& value)
+{
+   int parsed = 0;
+   if (!ParseNonNegative(text, parsed) || !parsed)
+      return false;
+
+   value = parsed;
+   return true;
+}
+
+static bool ParseSize(const std::string& text, int& width, int& height)
+{
+   std::string::size_type separator = text.find('x');
+   if (separator == std::string::npos)
+      return false;
+
+   return ParsePositive(text.substr(0, separator), width)
+      && ParsePositive(text.substr(separator + 1), height);
+}
+
+static std::vector<std::string> SplitList(const std::string& text)
+{
+   std::vector<std::string> items;
+   std::string::size_type start = 0;
+   while (start <= text.size())
+   {
+      std::string::size_type end = text.find(',', start);
+      if (end == std::string::npos)
+         end = text.size();
+
+      items.push_back(text.substr(start, end - start));
+      start = end + 1;
+   }
+   return items;
+}
+
+static bool ParseSizeList(const std::string& text, std::vector<BenchmarkSize>& sizes)
+{
+   if (text == "ladder")
+   {
+      sizes.assign(sizeLadder, sizeLadder + sizeof(sizeLadder) / sizeof(sizeLadder[0]));
+      return true;
+   }
+
+   std::vector<std::string> items = SplitList(text);
+   sizes.clear();
+   for (size_t i = 0; i < items.size(); ++i)
+   {
+      BenchmarkSize size;
+      if (!ParseSize(items[i], size.width, size.height))
+      {
+         fprintf(stderr, "invalid size '%s'\n", items[i].c_str());
+         return false;
+      }
+      sizes.push_back(size);
+   }
+
+   return true;
+}
+
+static bool ParseClockList(const std::string& text, std::vector<unsigned>& counts)
+{
+   if (text == "ladder")
+   {
+      counts.assign(clockLadder, clockLadder + sizeof(clockLadder) / sizeof(clockLadder[0]));
+      return true;
+   }
+
+   std::vector<std::string> items = SplitList(text);
+   counts.clear();
+   for (size_t i = 0; i < items.size(); ++i)
+   {
+      int count = 0;
+      if (!ParsePositive(items[i], count))
+      {
+         fprintf(stderr, "invalid clock count '%s'\n", items[i].c_str());
+         return false;
+      }
+      counts.push_back(count);
+   }
+
+   return true;
+}
+
+static bool ParseThreadList(const std::string& text, std::vector<unsigned>& counts)
+{
+   if (text == "ladder")
+   {
+      unsigned processors = WorkerPool::hardwareThreads();
+      counts.clear();
+      for (unsigned threads = 1; threads < processors; threads *= 2)
+         counts.push_back(threads);
+      counts.push_back(processors);
+      return true;
+   }
+
+   std::vector<std::string> items = SplitList(text);
+   counts.clear();
+   for (size_t i = 0; i < items.size(); ++i)
+   {
+      int count = 0;
+      if (!ParsePositive(items[i], count))
+      {
+         fprintf(stderr, "invalid thread count '%s'\n", items[i].c_str());
+         return false;
+      }
+      counts.push_back(count);
+   }
+
+   return true;
+}
+
+// Modes are separated by ',' after /cairo and by '+' in a renderer name such
+// as "cairo:layers+patterns", where ',' already separates the renderers.
+static bool ParseCairoFlags(const std::string& text, unsigned& flags)
+{
+   std::string::size_type start = 0;
+   while (start <= text.size())
+   {
+      std::string::size_type end = text.find_first_of(",+", start);
+      if (end == std::string::npos)
+         end = text.size();
+
+      std::string name = text.substr(start, end - start);
+      bool found = false;
+      for (size_t i = 0; i < sizeof(cairoFlagNames) / sizeof(cairoFlagNames[0]); ++i)
+      {
+         if (name == cairoFlagNames[i].name)
+         {
+            flags |= cairoFlagNames[i].flag;
+            found = true;
+         }
+      }
+
+      if (!found)
+      {
+         fprintf(stderr, "unknown cairo mode '%s'\n", name.c_str());
+         return false;
+      }
+
+      start = end + 1;
+   }
+
+   return true;
+}
+
+static bool FindImageFormat(const std::string& name, cairo_format_t& format)
+{
+   for (size_t i = 0; i < sizeof(imageFormatNames) / sizeof(imageFormatNames[0]); ++i)
+   {
+      if (name == imageFormatNames[i].name)
+      {
+         format = imageFormatNames[i].format;
+         return true;
+      }
+   }
+   return false;
+}
+
+bool ParseBenchmarkArguments(const std::vector<std::string>& args, BenchmarkOptions& options)
+{
+   for (size_t i = 0; i < args.size(); ++i)
+   {
+      const std::string& arg = args[i];
+      bool hasValue = i + 1 < args.size();
+
+      if (IsOption(arg, "bench"))
+         continue;
+
+      if (IsOption(arg, "renderer") && hasValue)
+         options.renderer = args[++i];
+      else if (IsOption(arg, "frames") && hasValue)
+      {
+         if (!ParsePositive(args[++i], options.frames))
+         {
+            fprintf(stderr, "invalid frame count '%s'\n", args[i].c_str());
+            return false;
+         }
+      }
+      else if (IsOption(arg, "cachebudget") && hasValue)
+      {
+         if (!ParsePositive(args[++i], options.frameCacheMB))
+         {
+            fprintf(stderr, "invalid frame cache budget '%s'\n", args[i].c_str());
+            return false;
+         }
+      }
+      else if (IsOption(arg, "format") && hasValue)
+      {
+         options.imageFormat = args[++i];
+         cairo_format_t format;
+         if (!FindImageFormat(options.imageFormat, format))
+         {
+            fprintf(stderr, "invalid image format '%s'\n", options.imageFormat.c_str());
+            return false;
+         }
+      }
+      else if (IsOption(arg, "stride") && hasValue)
+      {
+         // cairo only takes rows that start on a 4-byte boundary.
+         if (!ParsePositive(args[++i], options.imageStride) || options.imageStride % 4)
+         {
+            fprintf(stderr, "invalid stride '%s', expected a positive multiple of 4\n", args[i].c_str());
+            return false;
+         }
+      }
+      else if (IsOption(arg, "capture") && hasValue)
+         options.capturePath = args[++i];
+#if !defined(NO_CAIRO_SCRIPT_INTERPRETER)
+      else if (IsOption(arg, "replay") && hasValue)
+         options.replayPaths = SplitList(args[++i]);
+      else if (IsOption(arg, "passes") && hasValue)
+      {
+         if (!ParsePositive(args[++i], options.replayPasses))
+         {
+            fprintf(stderr, "invalid pass count '%s'\n", args[i].c_str());
+            return false;
+         }
+      }
+#endif
+      else if (IsOption(arg, "warmup") && hasValue)
+      {
+         if (!ParseNonNegative(args[++i], options.warmupFrames))
+         {
+            fprintf(stderr, "invalid warmup frame count '%s'\n", args[i].c_str());
+            return false;
+         }
+      }
+      else if (IsOption(arg, "size") && hasValue)
+      {
+         if (!ParseSize(args[++i], options.width, options.height))
+         {
+            fprintf(stderr, "invalid size '%s', expected <width>x<height>\n", args[i].c_str());
+            return false;
+         }
+      }
+      else if (IsOption(arg, "histogram") && hasValue)
+         options.histogramPath = args[++i];
+      else if (IsOption(arg, "sweep") && hasValue)
+      {
+         if (!ParseSizeList(args[++i], options.sweepSizes))
+            return false;
+      }
+      else if (IsOption(arg, "clocks") && hasValue)
+      {
+         int clocks = 0;
+         if (!ParsePositive(args[++i], clocks))
+         {
+            fprintf(stderr, "invalid clock count '%s'\n", args[i].c_str());
+            return false;
+         }
+         options.clocks = clocks;
+      }
+      else if (IsOption(arg, "scene") && hasValue)
+      {
+         if (!ParseClockList(args[++i], options.sweepClocks))
+            return false;
+      }
+      else if (IsOption(arg, "threads") && hasValue)
+      {
+         if (!ParseThreadList(args[++i], options.sweepThreads))
+            return false;
+
+         // A single count is a setting, not a sweep.
+         if (options.sweepThreads.size() == 1)
+         {
+            options.threads = options.sweepThreads[0];
+            options.sweepThreads.clear();
+         }
+      }
+      else if (IsOption(arg, "instances") && hasValue)
+      {
+         if (!ParseThreadList(args[++i], options.instances))
+            return false;
+      }
+      else if (IsOption(arg, "table") && hasValue)
+         options.tablePath = args[++i];
+      else if (IsOption(arg, "phases"))
+         options.phases = true;
+      else if (IsOption(arg, "pixelops"))
+         options.pixelOps = true;
+      else if (IsOption(arg, "displaylist"))
+         options.displayList = true;
+      else if (IsOption(arg, "time") && hasValue)
+      {
+         options.timeSource = args[++i];
+         FrameClock clock;
+         if (!clock.configure(options.timeSource))
+         {
+            fprintf(stderr, "invalid time source '%s'\n", options.timeSource.c_str());
+            return false;
+         }
+      }
+      else if (IsOption(arg, "pace") && hasValue)
+      {
+         // On-demand pacing has nothing to wait for offscreen.
+         options.pacing = args[++i];
+         FrameScheduler scheduler;
+         if (options.pacing == "ondemand" || !scheduler.configure(options.pacing))
+         {
+            fprintf(stderr, "invalid pacing '%s'\n", options.pacing.c_str());
+            return false;
+         }
+      }
+      else if (IsOption(arg, "cairo") && hasValue)
+      {
+         if (!ParseCairoFlags(args[++i], options.cairoFlags))
+            return false;
+      }
+      else
+      {
+         fprintf(stderr, "unknown argument '%s'\n", arg.c_str());
+         return false;
+      }
+   }
+
+   // Every instance would write its trace to the same file.
+   if (!options.instances.empty() && !options.capturePath.empty())
+   {
+      fprintf(stderr, "/capture cannot be combined with /instances\n");
+      return false;
+   }
+
+   return true;
+}
+
+static IRenderTest* CreateRenderer(const BenchmarkOptions& options, OffscreenTarget& target)
+{
+   // "cairo:layers+patterns" selects cairo with extra modes, so a single sweep
+   // can compare several cairo configurations side by side.
+   std::string name = options.renderer;
+   unsigned cairoFlags = options.cairoFlags;
+   std::string::size_type colon = name.find(':');
+   if (colon != std::string::npos)
+   {
+      unsigned extraFlags = 0;
+      if (name.compare(0, colon, "cairo") != 0 || !ParseCairoFlags(name.substr(colon + 1), extraFlags))
+         return 0;
+      cairoFlags |= extraFlags;
+      name.erase(colon);
+   }
+
+   if (name == "cairo")
+   {
+      CairoRenderer* renderer = new CairoRenderer(target.window(), target.bitmapDC());
+      if (!renderer->SetRenderFlags(cairoFlags))
+      {
+         fprintf(stderr, "these cairo modes cannot be combined\n");
+         delete renderer;
+         return 0;
+      }
+      renderer->SetThreads(options.threads);
+      if (options.frameCacheMB)
+         renderer->SetFrameCacheBudget(static_cast<size_t>(options.frameCacheMB) * 1024 * 1024);
+      return renderer;
+   }
+   if (name == "cairoimage")
+   {
+      cairo_format_t format = CAIRO_FORMAT_ARGB32;
+      FindImageFormat(options.imageFormat, format);
+
+      CairoImageRenderer* renderer = new CairoImageRenderer(options.width, options.height, format, options.imageStride);
+      if (!renderer->IsValid())
+      {
+         delete renderer;
+         return 0;
+      }
+      return renderer;
+   }
+   if (name == "cairogl")
+      return new CairoGLRenderer(target.window(), target.windowDC());
+   if (name == "cairogloffscreen")
+   {
+      CairoGLOffscreenRenderer* renderer = new CairoGLOffscreenRenderer(target.window(), target.windowDC());
+      if (!renderer->IsValid())
+      {
+         delete renderer;
+         return 0;
+      }
+      return renderer;
+   }
+   if (name == "d2d")
+      return new D2DRenderer(target.window(), target.windowDC());
+#if !defined(NO_CORE_GRAPHICS)
+   if (name == "cg")
+      return new CGRenderer(target.window(), target.bitmapDC());
+#endif
+   return 0;
+}
+
+static void WriteBenchmarkReport(FILE* out, const BenchmarkOptions& options, const BenchmarkResult& result, IRenderTest* test)
+{
+   fprintf(out, "renderer   : %s\n", options.renderer.c_str());
+   fprintf(out, "size       : %dx%d\n", options.width, options.height);
+   if (options.clocks > 1)
+      fprintf(out, "clocks     : %u (%u primitives)\n", options.clocks, options.clocks * primitivesPerClock);
+   if (options.displayList)
+      fprintf(out, "drawing    : display list\n");
+   if (options.cairoFlags & e_CairoTiles)
+      fprintf(out, "threads    : %u\n", options.threads ? options.threads : WorkerPool::hardwareThreads());
+   fprintf(out, "frames     : %d\n", result.frames);
+   fprintf(out, "wall time  : %.3f s\n", result.wallSeconds);
+   fprintf(out, "cpu time   : %.3f s\n", result.cpuSeconds);
+   fprintf(out, "frames/sec : %.1f\n", result.framesPerSecond());
+   fprintf(out, "frame time : ");
+   result.frameTimes.writeSummary(out);
+
+   if (result.pacing.mode() != FrameScheduler::e_Uncapped)
+      result.pacing.writeReport(out);
+
+   if (options.phases)
+   {
+      fprintf(out, "\n");
+      result.phases.writeTable(out);
+   }
+
+   fprintf(out, "\n");
+   test->WriteStatistics(out);
+}
+
+bool RunBenchmark(const BenchmarkOptions& options, BenchmarkResult& result, FILE* report)
+{
+   OffscreenTarget target(options.width, options.height);
+   if (!target.isValid())
+   {
+      fprintf(stderr, "could not create a %dx%d offscreen target\n", options.width, options.height);
+      return false;
+   }
+
+   IRenderTest* test = CreateRenderer(options, target);
+   if (!test)
+   {
+      fprintf(stderr, "could not create renderer '%s'\n", options.renderer.c_str());
+      return false;
+   }
+
+   if (options.displayList && !test->SetDisplayListMode(true))
+   {
+      fprintf(stderr, "renderer '%s' has no display list mode with these settings\n", options.renderer.c_str());
+      delete test;
+      return false;
+   }
+
+   HWND hWnd = target.window();
+   HDC hdc = target.windowDC();
+
+   FrameClock clock;
+   clock.configure(options.timeSource);
+
+   for (int i = 0; i < options.warmupFrames; ++i)
+   {
+      FrameContext frame = clock.nextFrame(0.0f);
+      frame.clocks = options.clocks;
+      test->RenderDemo(hWnd, hdc, options.height, options.width, frame);
+   }
+
+   // Timed frames always start from the same simulated time.
+   clock.rewind();
+   test->ResetStatistics();
+
+   // Only the timed frames go into the trace.
+   if (!options.capturePath.empty() && !test->SetScriptCapture(options.capturePath.c_str()))
+   {
+      fprintf(stderr, "renderer '%s' could not capture a cairo-script trace\n", options.renderer.c_str());
+      delete test;
+      return false;
+   }
+
+   // Unless paced, every frame is rendered back to back.
+   FrameScheduler& scheduler = result.pacing;
+   scheduler.configure(options.pacing);
+
+   if (options.startBarrier)
+      options.startBarrier->wait();
+
+   double startTime = MonotonicTime();
+   double startCPU = ProcessCPUTime();
+   float fps = 0.0f;
+
+   if (options.phases)
+      RenderPhaseStatistics::setCurrent(&result.phases);
+
+   for (int i = 0; i < options.frames; ++i)
+   {
+      scheduler.waitForNextFrame();
+      scheduler.beginFrame();
+
+      double frameStart = MonotonicTime();
+
+      if (options.phases)
+         result.phases.beginFrame();
+
+      FrameContext frame = clock.nextFrame(fps);
+      frame.clocks = options.clocks;
+      test->RenderDemo(hWnd, hdc, options.height, options.width, frame);
+
+      if (options.phases)
+         result.phases.endFrame();
+
+      double frameEnd = MonotonicTime();
+      result.frameTimes.record(frameEnd - frameStart);
+      scheduler.endFrame();
+
+      double elapsed = frameEnd - startTime;
+      fps = elapsed > 0.0 ? static_cast<float>((i + 1) / elapsed) : 0.0f;
+   }
+
+   result.frames = options.frames;
+   result.startTime = startTime;
+   result.endTime = MonotonicTime();
+   result.wallSeconds = result.endTime - startTime;
+   result.cpuSeconds = ProcessCPUTime() - startCPU;
+
+   RenderPhaseStatistics::setCurrent(0);
+
+   if (report)
+      WriteBenchmarkReport(report, options, result, test);
+
+   delete test;
+   return true;
+}
+
+bool RunSweep(const BenchmarkOptions& options, FILE* out)
+{
+   ResultTable table;
+   table.addColumn("renderer");
+   table.addColumn("width");
+   table.addColumn("height");
+   table.addColumn("megapixels");
+   table.addColumn("clocks");
+   table.addColumn("primitives");
+   table.addColumn("frames");
+   table.addColumn("fps");
+   table.addColumn("MP/s");
+   table.addColumn("p50_ms");
+   table.addColumn("p99_ms");
+   table.addColumn("us_per_clock");
+   table.addColumn("threads");
+   table.addColumn("speedup");
+
+   std::vector<BenchmarkSize> sizes = options.sweepSizes;
+   if (sizes.empty())
+   {
+      BenchmarkSize size = { options.width, options.height };
+      sizes.push_back(size);
+   }
+
+   std::vector<unsigned> clockCounts = options.sweepClocks;
+   if (clockCounts.empty())
+      clockCounts.push_back(options.clocks);
+
+   std::vector<unsigned> threadCounts = options.sweepThreads;
+   if (threadCounts.empty())
+      threadCounts.push_back(options.threads);
+
+   std::vector<std::string> renderers = SplitList(options.renderer);
+   for (size_t r = 0; r < renderers.size(); ++r)
+   {
+      for (size_t s = 0; s < sizes.size(); ++s)
+      {
+         for (size_t c = 0; c < clockCounts.size(); ++c)
+         {
+            double baselineFPS = 0.0;
+
+            for (size_t t = 0; t < threadCounts.size(); ++t)
+            {
+               BenchmarkOptions run = options;
+               run.renderer = renderers[r];
+               run.width = sizes[s].width;
+               run.height = sizes[s].height;
+               run.clocks = clockCounts[c];
+               run.threads = threadCounts[t] ? threadCounts[t] : WorkerPool::hardwareThreads();
+
+               // Progress goes to stderr so stdout stays a clean table.
+               fprintf(stderr, "%s %dx%d %u clocks %u threads...\n", run.renderer.c_str(), run.width, run.height,
+                       run.clocks, run.threads);
+
+               BenchmarkResult result;
+               if (!RunBenchmark(run, result))
+                  return false;
+
+               double megapixels = run.width * static_cast<double>(run.height) / 1.0e6;
+               double meanFrameTime = result.frames ? result.wallSeconds / result.frames : 0.0;
+               if (!t)
+                  baselineFPS = result.framesPerSecond();
+
+               table.beginRow();
+               table.addCell(run.renderer);
+               table.addCell(run.width);
+               table.addCell(run.height);
+               table.addCell(megapixels, "%.4f");
+               table.addCell(static_cast<int>(run.clocks));
+               table.addCell(static_cast<int>(run.clocks * primitivesPerClock));
+               table.addCell(result.frames);
+               table.addCell(result.framesPerSecond(), "%.1f");
+               table.addCell(result.framesPerSecond() * megapixels, "%.1f");
+               table.addCell(result.frameTimes.percentile(50) * 1000.0, "%.3f");
+               table.addCell(result.frameTimes.percentile(99) * 1000.0, "%.3f");
+               table.addCell(meanFrameTime / run.clocks * 1.0e6, "%.2f");
+               table.addCell(static_cast<int>(run.threads));
+               table.addCell(baselineFPS > 0.0 ? result.framesPerSecond() / baselineFPS : 0.0, "%.2f");
+            }
+         }
+      }
+   }
+
+   table.write(out);
+
+   return options.tablePath.empty() || table.writeCSV(options.tablePath);
+}
+
+struct ThroughputJob
+{
+   BenchmarkOptions options;
+   std::vector<BenchmarkResult> results;
+   std::vector<char> succeeded;
+};
+
+static void RunInstance(void* context, unsigned index)
+{
+   ThroughputJob* job = static_cast<ThroughputJob*>(context);
+   job->succeeded[index] = RunBenchmark(job->options, job->results[index]);
+
+   // A failed instance never reached the barrier; stand in for it so the
+   // others are not left waiting.
+   if (!job->succeeded[index])
+      job->options.startBarrier->wait();
+}
+
+bool RunThroughput(const BenchmarkOptions& options, FILE* out)
+{
+   ResultTable table;
+   table.addColumn("renderer");
+   table.addColumn("instances");
+   table.addColumn("frames");
+   table.addColumn("aggregate_fps");
+   table.addColumn("scaling");
+   table.addColumn("min_instance_fps");
+   table.addColumn("max_instance_fps");
+   table.addColumn("p50_ms");
+   table.addColumn("p99_ms");
+   table.addColumn("max_ms");
+
+   std::vector<std::string> renderers = SplitList(options.renderer);
+   for (size_t r = 0; r < renderers.size(); ++r)
+   {
+      double baselineFPS = 0.0;
+
+      for (size_t n = 0; n < options.instances.size(); ++n)
+      {
+         unsigned instances = options.instances[n];
+         fprintf(stderr, "%s x%u...\n", renderers[r].c_str(), instances);
+
+         ThreadBarrier barrier(instances);
+
+         ThroughputJob job;
+         job.options = options;
+         job.options.renderer = renderers[r];
+         job.options.startBarrier = &barrier;
+         job.results.resize(instances);
+         job.succeeded.resize(instances);
+
+         // Every instance blocks in the barrier until all have started, so
+         // each of the pool's threads ends up running exactly one of them.
+         {
+            WorkerPool pool(instances);
+            pool.run(RunInstance, &job, instances);
+         }
+
+         int frames = 0;
+         double start = 0.0;
+         double end = 0.0;
+         double minimumFPS = 0.0;
+         double maximumFPS = 0.0;
+         LatencyHistogram frameTimes;
+         for (unsigned i = 0; i < instances; ++i)
+         {
+            if (!job.succeeded[i])
+               return false;
+
+            const BenchmarkResult& result = job.results[i];
+            frames += result.frames;
+            start = i ? std::min(start, result.startTime) : result.startTime;
+            end = i ? std::max(end, result.endTime) : result.endTime;
+            minimumFPS = i ? std::min(minimumFPS, result.framesPerSecond()) : result.framesPerSecond();
+            maximumFPS = i ? std::max(maximumFPS, result.framesPerSecond()) : result.framesPerSecond();
+            frameTimes.add(result.frameTimes);
+         }
+
+         double aggregateFPS = end > start ? frames / (end - start) : 0.0;
+         if (!n)
+            baselineFPS = aggregateFPS;
+
+         table.beginRow();
+         table.addCell(renderers[r]);
+         table.addCell(static_cast<int>(instances));
+         table.addCell(frames);
+         table.addCell(aggregateFPS, "%.1f");
+         table.addCell(baselineFPS > 0.0 ? aggregateFPS / baselineFPS : 0.0, "%.2f");
+         table.addCell(minimumFPS, "%.1f");
+         table.addCell(maximumFPS, "%.1f");
+         table.addCell(frameTimes.percentile(50) * 1000.0, "%.3f");
+         table.addCell(frameTimes.percentile(99) * 1000.0, "%.3f");
+         table.addCell(frameTimes.maximum() * 1000.0, "%.3f");
+      }
+   }
+
+   table.write(out);
+
+   return options.tablePath.empty() || table.writeCSV(options.tablePath);
+}
+
+static bool EndsWith(const std::string& text, const char* suffix)
+{
+   size_t length = strlen(suffix);
+   return text.size() >= length && !strcmp(text.c_str() + text.size() - length, suffix);
+}
+
+static bool WriteHistogram(const std::string& path, const LatencyHistogram& histogram)
+{
+   FILE* out = fopen(path.c_str(), "w");
+   if (!out)
+   {
+      fprintf(stderr, "could not open '%s' for writing\n", path.c_str());
+      return false;
+   }
+
+   if (EndsWith(path, ".csv"))
+      histogram.writeCSV(out);
+   else
+      histogram.writeJSON(out);
+
+   fclose(out);
+   return true;
+}
+
+enum PixelKernel
+{
+   e_SetAlphaKernel,
+   e_FillKernel,
+   e_PremultiplyKernel,
+   e_UnpremultiplyKernel,
+   e_PixelKernelCount
+};
+
+static const char* const pixelKernelNames[e_PixelKernelCount] = { "set_alpha", "fill", "premultiply", "unpremultiply" };
+
+/**
+  Fills pixels with the same premultiplied pixels for every run, with some
+  fully transparent and some opaque ones among them.
+*/
+static void FillTestPixels(std::vector<unsigned>& pixels)
+{
+   unsigned seed = 12345;
+   for (size_t i = 0; i < pixels.size(); ++i)
+   {
+      seed = seed * 1103515245 + 12345;
+      unsigned a = (seed >> 16) & 0xff;
+      if (i % 7 == 0)
+         a = (i % 14) ? 0xff : 0;
+
+      const unsigned colour = seed >> 8;
+      const unsigned b = (colour & 0xff) * a / 255;
+      const unsigned g = ((colour >> 8) & 0xff) * a / 255;
+      const unsigned r = ((colour >> 16) & 0xff) * a / 255;
+      pixels[i] = (a << 24) | (r << 16) | (g << 8) | b;
+   }
+}
+
+static void RunPixelKernel(PixelKernel kernel, const PixelKernels& kernels, std::vector<unsigned>& pixels,
+                           int width, int height)
+{
+   unsigned char* data = reinterpret_cast<unsigned char*>(&pixels[0]);
+   const ptrdiff_t stride = width * 4;
+   const PixelRect all = { 0, 0, width, height };
+
+   switch (kernel)
+   {
+   case e_SetAlphaKernel:
+      SetPixelAlpha(data, stride, width, height, all, 0x80, kernels);
+      break;
+   case e_FillKernel:
+      FillPixels(data, stride, width, height, all, 0x80402010, kernels);
+      break;
+   case e_PremultiplyKernel:
+      PremultiplyPixels(data, stride, width, height, all, kernels);
+      break;
+   default:
+      UnpremultiplyPixels(data, stride, width, height, all, kernels);
+      break;
+   }
+}
+
+bool RunPixelBenchmark(const BenchmarkOptions& options, FILE* out)
+{
+   const size_t count = static_cast<size_t>(options.width) * options.height;
+   const double bytes = static_cast<double>(count) * 4;
+
+   std::vector<unsigned> pixels(count);
+   std::vector<unsigned> expected(count);
+
+   ResultTable table;
+   table.addColumn("kernel");
+   table.addColumn("isa");
+   table.addColumn("width");
+   table.addColumn("height");
+   table.addColumn("passes");
+   table.addColumn("GB/s");
+   table.addColumn("speedup");
+   table.addColumn("exact");
+
+   for (int kernel = 0; kernel < e_PixelKernelCount; ++kernel)
+   {
+      // The scalar kernel's output on fresh pixels is the reference.
+      FillTestPixels(expected);
+      RunPixelKernel(static_cast<PixelKernel>(kernel), *PixelKernelsFor(e_PixelScalar), expected,
+                     options.width, options.height);
+
+      double scalarRate = 0.0;
+      for (int set = 0; set < e_PixelInstructionSetCount; ++set)
+      {
+         const PixelKernels* kernels = PixelKernelsFor(static_cast<PixelInstructionSet>(set));
+         if (!kernels)
+            continue;
+
+         FillTestPixels(pixels);
+         RunPixelKernel(static_cast<PixelKernel>(kernel), *kernels, pixels, options.width, options.height);
+         const bool exact = pixels == expected;
+
+         // Later passes see already processed pixels, which costs the same.
+         double start = MonotonicTime();
+         for (int pass = 0; pass < options.frames; ++pass)
+            RunPixelKernel(static_cast<PixelKernel>(kernel), *kernels, pixels, options.width, options.height);
+         double seconds = MonotonicTime() - start;
+
+         double rate = seconds > 0.0 ? bytes * options.frames / seconds / 1e9 : 0.0;
+         if (set == e_PixelScalar)
+            scalarRate = rate;
+
+         table.beginRow();
+         table.addCell(pixelKernelNames[kernel]);
+         table.addCell(kernels->name);
+         table.addCell(options.width);
+         table.addCell(options.height);
+         table.addCell(options.frames);
+         table.addCell(rate, "%.2f");
+         table.addCell(scalarRate > 0.0 ? rate / scalarRate : 0.0, "%.2f");
+         table.addCell(exact ? "yes" : "no");
+      }
+   }
+
+   table.write(out);
+
+   return options.tablePath.empty() || table.writeCSV(options.tablePath);
+}
+
+#if !defined(NO_CAIRO_SCRIPT_INTERPRETER)
+bool RunReplayBenchmark(const BenchmarkOptions& options, FILE* out)
+{
+   ResultTable table;
+   table.addColumn("trace");
+   table.addColumn("pages");
+   table.addColumn("passes");
+   table.addColumn("ms/pass");
+   table.addColumn("ms/page");
+
+   bool succeeded = true;
+   for (size_t i = 0; i < options.replayPaths.size(); ++i)
+   {
+      const std::string& path = options.replayPaths[i];
+
+      CairoScriptReplayResult result;
+      if (!ReplayCairoScript(path.c_str(), options.replayPasses, result))
+      {
+         fprintf(stderr, "could not replay '%s': %s\n", path.c_str(), result.error.c_str());
+         succeeded = false;
+         continue;
+      }
+
+      double msPerPass = 1000.0 * result.seconds / options.replayPasses;
+
+      table.beginRow();
+      table.addCell(path.c_str());
+      table.addCell(static_cast<int>(result.pages));
+      table.addCell(options.replayPasses);
+      table.addCell(msPerPass, "%.3f");
+      table.addCell(result.pages ? msPerPass / result.pages : 0.0, "%.3f");
+   }
+
+   table.write(out);
+
+   if (!options.tablePath.empty() && !table.writeCSV(options.tablePath))
+      return false;
+   return succeeded;
+}
+#endif
+
+int BenchmarkMain(const std::vector<std::string>& args)
+{
+   BenchmarkOptions options;
+   if (!ParseBenchmarkArguments(args, options))
+   {
+      PrintBenchmarkUsage(stderr);
+      return EXIT_FAILURE;
+   }
+
+   if (options.pixelOps)
+      return RunPixelBenchmark(options, stdout) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+#if !defined(NO_CAIRO_SCRIPT_INTERPRETER)
+   if (!options.replayPaths.empty())
+      return RunReplayBenchmark(options, stdout) ? EXIT_SUCCESS : EXIT_FAILURE;
+#endif
+
+   if (!options.instances.empty())
+      return RunThroughput(options, stdout) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+   if (!options.sweepSizes.empty() || !options.sweepClocks.empty() || !options.sweepThreads.empty())
+      return RunSweep(options, stdout) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+   BenchmarkResult result;
+   if (!RunBenchmark(options, result, stdout))
+      return EXIT_FAILURE;
+
+   if (!options.histogramPath.empty() && !WriteHistogram(options.histogramPath, result.frameTimes))
+      return EXIT_FAILURE;
+
+   return EXIT_SUCCESS;
+}
+
+bool IsBenchmarkCommandLine(const wchar_t* commandLine)
+{
+   // CommandLineToArgvW returns the executable path for an empty string.
+   if (!commandLine || !*commandLine)
+      return false;
+
+   int argc = 0;
+   LPWSTR* argv = ::CommandLineToArgvW(commandLine, &argc);
+   if (!argv)
+      return false;
+
+   bool bench = false;
+   for (int i = 0; i < argc && !bench; ++i)
+      bench = !wcscmp(argv[i], L"/bench") || !wcscmp(argv[i], L"-bench");
+
+   ::LocalFree(argv);
+   return bench;
+}
+
+/**
+  The executable is linked for the GUI subsystem, so attach to the console of
+  whoever started us (or open a new one) before printing results.
+*/
+static void AttachBenchmarkConsole()
+{
+   if (!::AttachConsole(ATTACH_PARENT_PROCESS))
+      ::AllocConsole();
+
+   freopen("CONOUT$", "w", stdout);
+   freopen("CONOUT$", "w", stderr);
+}
+
+int RunBenchmarkFromCommandLine()
+{
+   AttachBenchmarkConsole();
+
+   int argc = 0;
+   LPWSTR* argv = ::CommandLineToArgvW(::GetCommandLineW(), &argc);
+   if (!argv)
+      return EXIT_FAILURE;
+
+   // Skip the executable name.
+   std::vector<std::string> args;
+   for (int i = 1; i < argc; ++i)
+   {
+      char buffer[MAX_PATH];
+      if (::WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, buffer, sizeof(buffer), 0, 0))
+         args.push_back(buffer);
+   }
+   ::LocalFree(argv);
+
+   int exitCode = BenchmarkMain(args);
+   fflush(stdout);
+   return exitCode;
+}
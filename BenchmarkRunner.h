@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include "FrameScheduler.h"
+#include "LatencyHistogram.h"
+#include "RenderZones.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class ThreadBarrier;
+
+struct BenchmarkSize
+{
+   int width;
+   int height;
+};
+
+/**
+  Settings for one headless benchmark run, filled in from the command line.
+*/
+struct BenchmarkOptions
+{
+   BenchmarkOptions();
+
+   std::string renderer;
+   int frames;
+   int warmupFrames;
+   int width;
+   int height;
+   std::string histogramPath;
+   bool phases;
+   unsigned cairoFlags;
+   bool displayList;       // replay a retained ClockDisplayList, see IRenderTest::SetDisplayListMode
+   std::string timeSource;
+   std::string pacing;
+   unsigned clocks;
+   unsigned threads;       // for parallel modes; 0 means one per logical processor
+   bool pixelOps;          // run the PixelOps kernel microbenchmark instead of a renderer
+   int frameCacheMB;       // memory budget of the cairo frame cache; 0 keeps the renderer's default
+   std::string imageFormat;  // pixel format of the cairoimage renderer
+   int imageStride;        // row stride of the cairoimage renderer in bytes; 0 packs the rows
+   std::string capturePath;  // record the cairo renderer's timed frames into this cairo-script trace
+
+   // Replay mode: each cairo-script trace is run replayPasses times instead
+   // of rendering frames.
+   std::vector<std::string> replayPaths;
+   int replayPasses;
+
+   // Sweeps: every renderer in the comma separated renderer list is run at
+   // each of these sizes (instead of width x height), clock counts (instead
+   // of clocks) and thread counts (instead of threads).
+   std::vector<BenchmarkSize> sweepSizes;
+   std::vector<unsigned> sweepClocks;
+   std::vector<unsigned> sweepThreads;
+   std::string tablePath;
+
+   // Throughput mode: each count runs that many independent renderer
+   // instances, one per thread.
+   std::vector<unsigned> instances;
+
+   // If set, the timed frames start only once every thread sharing the
+   // barrier has finished its warmup.
+   ThreadBarrier* startBarrier;
+};
+
+struct BenchmarkResult
+{
+   BenchmarkResult();
+
+   double framesPerSecond() const { return wallSeconds > 0.0 ? frames / wallSeconds : 0.0; }
+
+   int frames;
+   double startTime;       // MonotonicTime() around the timed frames
+   double endTime;
+   double wallSeconds;
+   double cpuSeconds;
+   LatencyHistogram frameTimes;
+   RenderPhaseStatistics phases;
+   FrameScheduler pacing;
+};
+
+/**
+  Parses arguments of the form "/renderer cairo /frames 1000 /size 400x400".
+  Returns false (after printing the reason) if an argument is not understood.
+*/
+bool ParseBenchmarkArguments(const std::vector<std::string>& args, BenchmarkOptions& options);
+
+/**
+  Renders options.frames frames offscreen, as fast as possible unless a
+  target rate is given in options.pacing. If report is
+  given, the results and any statistics gathered by the renderer itself are
+  written to it.
+*/
+bool RunBenchmark(const BenchmarkOptions& options, BenchmarkResult& result, FILE* report = 0);
+
+/**
+  Runs each renderer at each combination of options.sweepSizes,
+  options.sweepClocks and options.sweepThreads and prints throughput
+  (frames/sec, megapixels/sec), frame time per clock and the speedup over
+  the first thread count as a table (also written as CSV to
+  options.tablePath if set).
+*/
+bool RunSweep(const BenchmarkOptions& options, FILE* out);
+
+/**
+  For each count in options.instances, runs that many renderers of each kind
+  concurrently, each on its own thread with its own offscreen target, and
+  prints the aggregate frames/sec and the per-instance frame times as a
+  table.
+*/
+bool RunThroughput(const BenchmarkOptions& options, FILE* out);
+
+/**
+  Times each PixelOps kernel (set alpha, fill, premultiply, unpremultiply)
+  with every instruction set the processor supports over options.frames
+  passes of a width x height buffer, and prints GB/s of pixels processed,
+  the speedup over the scalar kernel and whether the pixels match those of
+  the scalar kernel.
+*/
+bool RunPixelBenchmark(const BenchmarkOptions& options, FILE* out);
+
+#if !defined(NO_CAIRO_SCRIPT_INTERPRETER)
+/**
+  Replays each trace in options.replayPaths into image surfaces through the
+  cairo-script interpreter and prints the time per pass of the trace and per
+  page (frame) in it as a table.
+*/
+bool RunReplayBenchmark(const BenchmarkOptions& options, FILE* out);
+#endif
+
+/**
+  Runs the benchmark described by args and prints a summary to stdout.
+  Returns the process exit code.
+*/
+int BenchmarkMain(const std::vector<std::string>& args);
+
+/**
+  True if the executable was started with "/bench" and should run the
+  benchmark instead of opening the interactive window.
+*/
+bool IsBenchmarkCommandLine(const wchar_t* commandLine);
+
+int RunBenchmarkFromCommandLine();
@@ -30,6 +30,8 @@
 #include "CGRoutines.h"
 
 #include "DIBPixelData.h"
+#include "ClockGrid.h"
+#include "RenderZones.h"
 
 #define _USE_MATH_DEFINES
 #include <cmath>
@@ -194,140 +196,166 @@ LRESULT PaintCGDemo (HWND hWnd, HDC hdc)
    return 0;
 }
 
-void CGRenderer::RenderDemo (HWND hWnd, HDC hdc, int height, int width, float fps)
+/**
+  Draws one clock centred on the origin of the current transform, which maps
+  a unit square onto the clock's cell.
+*/
+void CGRenderer::DrawClock (const ClockHands& hands)
 {
-   // Reset to identity
-   CGAffineTransform ctm = CGContextGetCTM(m_cr);
-   CGAffineTransform inverted = CGAffineTransformInvert(ctm);
-   CGContextConcatCTM(m_cr, inverted);
-
-   CGContextSaveGState(m_cr);
-
    float m_radius = 0.42f;
    float m_line_width = 0.05f;
 
-   CGContextScaleCTM(m_cr, width, height);
-   CGContextTranslateCTM(m_cr, 0.5f, 0.5f);
    CGContextSetLineWidth(m_cr, m_line_width);
 
-   // Background
-   CGContextSaveGState(m_cr);
-   CGContextSetRGBFillColor(m_cr, 0.337f, 0.612f, 0.117f, 0.9f);   // green
-   CGRect bounds = CGRectMake(-0.5f, -0.5f, 1.0f, 1.0f);
-   CGContextFillRect(m_cr, bounds);
-   CGContextRestoreGState(m_cr);
-
    // Clock face
-   CGContextAddArc(m_cr, 0.0f, 0.0f, m_radius, 0.0f, 2.0f * M_PI, 1);
-   CGContextSaveGState(m_cr);
-   CGContextSetRGBFillColor(m_cr, 1.0f, 1.0f, 1.0f, 0.8f);
-   CGContextFillPath(m_cr);
-   CGContextRestoreGState(m_cr);
-   CGContextSetRGBStrokeColor(m_cr, 0.0f, 0.0f, 0.0f, 1.0f);
-   CGContextAddArc(m_cr, 0.0f, 0.0f, m_radius, 0.0f, 2.0f * M_PI, 1);
-   CGContextStrokePath(m_cr);
+   {
+      RENDER_ZONE(e_PhaseFace);
+      CGContextAddArc(m_cr, 0.0f, 0.0f, m_radius, 0.0f, 2.0f * M_PI, 1);
+      CGContextSaveGState(m_cr);
+      CGContextSetRGBFillColor(m_cr, 1.0f, 1.0f, 1.0f, 0.8f);
+      CGContextFillPath(m_cr);
+      CGContextRestoreGState(m_cr);
+      CGContextSetRGBStrokeColor(m_cr, 0.0f, 0.0f, 0.0f, 1.0f);
+      CGContextAddArc(m_cr, 0.0f, 0.0f, m_radius, 0.0f, 2.0f * M_PI, 1);
+      CGContextStrokePath(m_cr);
+   }
 
    // clock ticks
-   for (int i = 0; i < 12; ++i)
    {
-      float inset = 0.05f;
+      RENDER_ZONE(e_PhaseTicks);
+      for (int i = 0; i < 12; ++i)
+      {
+         float inset = 0.05f;
 
-      CGContextSaveGState(m_cr);
-      CGContextSetLineCap(m_cr, kCGLineCapRound);
+         CGContextSaveGState(m_cr);
+         CGContextSetLineCap(m_cr, kCGLineCapRound);
 
-      if (i % 3 != 0)
-      {
-         inset *= 0.8;
-         CGContextSetLineWidth(m_cr, 0.03f);
+         if (i % 3 != 0)
+         {
+            inset *= 0.8;
+            CGContextSetLineWidth(m_cr, 0.03f);
+         }
+
+         const float angle = static_cast<float>(i * M_PI / 6.0);
+         const float sinAngle = sinf(angle);
+         const float cosAngle = cosf(angle);
+
+         CGContextMoveToPoint(m_cr, (m_radius - inset) * cosAngle, (m_radius - inset) * sinAngle);
+         CGContextAddLineToPoint(m_cr, m_radius * cosAngle, m_radius * sinAngle);
+         CGContextStrokePath(m_cr);
+         CGContextRestoreGState(m_cr); // stack-pen-size
       }
+   }
 
-      const float angle = static_cast<float>(i * M_PI / 6.0);
-      const float sinAngle = sinf(angle);
-      const float cosAngle = cosf(angle);
+   {
+      RENDER_ZONE(e_PhaseHands);
+
+      CGContextSaveGState(m_cr);
+      CGContextSetLineCap(m_cr, kCGLineCapRound);
+
+      // draw the seconds hand
+      CGContextSaveGState(m_cr);
+      CGContextSetLineWidth(m_cr, m_line_width / 3);
+      CGContextSetRGBStrokeColor(m_cr, 0.7f, 0.7f, 0.7f, 0.8f); // gray
+      CGContextMoveToPoint(m_cr, 0.0f, 0.0f);
+      float secondHandLength = 0.9f * m_radius;
+      float sinSec = sinf(hands.seconds);
+      float cosSec = cosf(hands.seconds);
+      CGContextAddLineToPoint(m_cr, sinSec * secondHandLength, cosSec * secondHandLength);
+      CGContextStrokePath(m_cr);
+      CGContextRestoreGState(m_cr);
+
+      // draw the minutes hand
+      CGContextSetRGBStrokeColor(m_cr, 0.117f, 0.337f, 0.612f, 0.9f);   // blue
+      CGContextMoveToPoint(m_cr, 0.0f, 0.0f);
+      float minuteHandLength = 0.8f * m_radius;
+      float sinMin = sinf(hands.minutes);
+      float cosMin = cosf(hands.minutes);
+      CGContextAddLineToPoint(m_cr, sinMin * minuteHandLength, cosMin * minuteHandLength);
+      CGContextStrokePath(m_cr);
 
-      CGContextMoveToPoint(m_cr, (m_radius - inset) * cosAngle, (m_radius - inset) * sinAngle);
-      CGContextAddLineToPoint(m_cr, m_radius * cosAngle, m_radius * sinAngle);
+      // draw the hours hand
+      CGContextSetRGBStrokeColor(m_cr, 0.337f, 0.612f, 0.117f, 0.9f);   // green
+      CGContextMoveToPoint(m_cr, 0.0f, 0.0f);
+      float hourHandLength = 0.5f * m_radius;
+      float sinHours = sinf(hands.hours);
+      float cosHours = cosf(hands.hours);
+      CGContextAddLineToPoint(m_cr, sinHours * hourHandLength, cosHours * hourHandLength);
       CGContextStrokePath(m_cr);
-      CGContextRestoreGState(m_cr); // stack-pen-size
+      CGContextRestoreGState(m_cr);
+
+      // draw a little dot in the middle
+      CGContextAddArc(m_cr, 0, 0, m_line_width / 3.0, 0.0f, 2.0f * M_PI, 1);
+      CGContextSetRGBFillColor(m_cr, 0.0f, 0.0f, 0.0f, 1.0f);
+      CGContextFillPath(m_cr);
    }
+}
 
-   // store the current time
-   SYSTEMTIME time;
-   GetLocalTime(&time);
-
-   // compute the angles of the indicators of our clock
-   double minutes = time.wMinute * M_PI / 30;
-   double hours = time.wHour * M_PI / 6;
-   double seconds= ((double)time.wSecond + (double)time.wMilliseconds / 1000) * M_PI / 30;
-
-   CGContextSaveGState(m_cr);
-   CGContextSetLineCap(m_cr, kCGLineCapRound);
-
-   // draw the seconds hand
-   CGContextSaveGState(m_cr);
-   CGContextSetLineWidth(m_cr, m_line_width / 3);
-   CGContextSetRGBStrokeColor(m_cr, 0.7f, 0.7f, 0.7f, 0.8f); // gray
-   CGContextMoveToPoint(m_cr, 0.0f, 0.0f);
-	float secondHandLength = 0.9f * m_radius;
-	float sinSec = sinf(seconds);
-   float cosSec = cosf(seconds);
-   CGContextAddLineToPoint(m_cr, sinSec * secondHandLength, cosSec * secondHandLength);
-   CGContextStrokePath(m_cr);
-   CGContextRestoreGState(m_cr);
-
-   // draw the minutes hand
-   CGContextSetRGBStrokeColor(m_cr, 0.117f, 0.337f, 0.612f, 0.9f);   // blue
-   CGContextMoveToPoint(m_cr, 0.0f, 0.0f);
-	float minuteHandLength = 0.8f * m_radius;
-	float sinMin = sinf(minutes + seconds/60);
-	float cosMin = cosf(minutes + seconds/60);
-   CGContextAddLineToPoint(m_cr, sinMin * minuteHandLength, cosMin * minuteHandLength);
-   CGContextStrokePath(m_cr);
-
-   // draw the hours hand
-   CGContextSetRGBStrokeColor(m_cr, 0.337f, 0.612f, 0.117f, 0.9f);   // green
-   CGContextMoveToPoint(m_cr, 0.0f, 0.0f);
-	float hourHandLength = 0.5f * m_radius;
-	float sinHours = sinf(hours + minutes / 12.0f);
-	float cosHours = cosf(hours + minutes / 12.0f);
-   CGContextAddLineToPoint(m_cr, sinHours * hourHandLength, cosHours * hourHandLength);
-   CGContextStrokePath(m_cr);
-   CGContextRestoreGState(m_cr);
-
-   // draw a little dot in the middle
-   CGContextAddArc(m_cr, 0, 0, m_line_width / 3.0, 0.0f, 2.0f * M_PI, 1);
-   CGContextSetRGBFillColor(m_cr, 0.0f, 0.0f, 0.0f, 1.0f);
-   CGContextFillPath(m_cr);
-
-   CGContextRestoreGState(m_cr);
+void CGRenderer::RenderDemo (HWND hWnd, HDC hdc, int height, int width, const FrameContext& frame)
+{
+   // Reset to identity
+   CGAffineTransform ctm = CGContextGetCTM(m_cr);
+   CGAffineTransform inverted = CGAffineTransformInvert(ctm);
+   CGContextConcatCTM(m_cr, inverted);
 
-   // Display FPS:
-   char message[100];
-   int length = sprintf(message, "fps: %0.2g", fps);
+   // Background
+   {
+      RENDER_ZONE(e_PhaseBackground);
+      CGContextSaveGState(m_cr);
+      CGContextSetRGBFillColor(m_cr, 0.337f, 0.612f, 0.117f, 0.9f);   // green
+      CGRect bounds = CGRectMake(0.0f, 0.0f, width, height);
+      CGContextFillRect(m_cr, bounds);
+      CGContextRestoreGState(m_cr);
+   }
 
-   // Attempt to display the text:
-   CGContextSetFont(m_cr, m_messageFont);
+   // CoreGraphics puts the origin at the bottom left, so count rows upwards
+   // from the top of the target.
+   ClockGrid grid(width, height, frame.clocks);
+   for (unsigned i = 0; i < grid.clocks(); ++i)
+   {
+      CGContextSaveGState(m_cr);
+      CGContextTranslateCTM(m_cr, grid.cellX(i), height - grid.cellY(i) - grid.cellHeight());
+      CGContextScaleCTM(m_cr, grid.cellWidth(), grid.cellHeight());
+      CGContextTranslateCTM(m_cr, 0.5f, 0.5f);
 
-   CGContextSetCharacterSpacing (m_cr, 10);
-   CGContextSetTextDrawingMode(m_cr, kCGTextStroke);
- 
-   CGContextShowTextAtPoint(m_cr, 10, height - 10, "Test", 9);
+      DrawClock(frame.handsForClock(i));
 
-   CGContextSetTextPosition(m_cr, 10, height - 10);
-   CGContextShowText(m_cr, "Test", 4);
+      CGContextRestoreGState(m_cr);
+   }
 
-   /*
-    * I could not get text rendering through CoreGraphics to work under Windows
-    * Draw a circle where we want the text to display:
-    */
-   CGContextAddArc(m_cr, 10, height - 10, 3.0, 0.0f, 2.0f * M_PI, 1);
-   CGContextSetRGBStrokeColor(m_cr, 0.0f, 0.0f, 0.0f, 1.0f);
-   CGContextSetRGBFillColor(m_cr, 0.0f, 0.0f, 0.0f, 1.0f);
-   CGContextFillPath(m_cr);
+   // Display FPS:
+   {
+      RENDER_ZONE(e_PhaseText);
+      char message[100];
+      int length = sprintf(message, "fps: %0.2g", frame.fps);
 
-   CGContextFlush(m_cr);
+      // Attempt to display the text:
+      CGContextSetFont(m_cr, m_messageFont);
 
-   ::BitBlt(hdc, 0, 0, m_bmpInfo.bmiHeader.biWidth, -m_bmpInfo.bmiHeader.biHeight, m_bitmapDC, 0, 0, SRCCOPY);
+      CGContextSetCharacterSpacing (m_cr, 10);
+      CGContextSetTextDrawingMode(m_cr, kCGTextStroke);
+ 
+      CGContextShowTextAtPoint(m_cr, 10, height - 10, "Test", 9);
+
+      CGContextSetTextPosition(m_cr, 10, height - 10);
+      CGContextShowText(m_cr, "Test", 4);
+
+      /*
+       * I could not get text rendering through CoreGraphics to work under Windows
+       * Draw a circle where we want the text to display:
+       */
+      CGContextAddArc(m_cr, 10, height - 10, 3.0, 0.0f, 2.0f * M_PI, 1);
+      CGContextSetRGBStrokeColor(m_cr, 0.0f, 0.0f, 0.0f, 1.0f);
+      CGContextSetRGBFillColor(m_cr, 0.0f, 0.0f, 0.0f, 1.0f);
+      CGContextFillPath(m_cr);
+   }
+
+   {
+      RENDER_ZONE(e_PhaseFlush);
+      CGContextFlush(m_cr);
+
+      ::BitBlt(hdc, 0, 0, m_bmpInfo.bmiHeader.biWidth, -m_bmpInfo.bmiHeader.biHeight, m_bitmapDC, 0, 0, SRCCOPY);
+   }
 
    /*
    RECT rect;
@@ -36,11 +36,13 @@ public:
 	CGRenderer(HWND hWnd, HDC hdc);
 	virtual ~CGRenderer();
 
-	void RenderDemo(HWND hWnd, HDC hdc, int height, int width, float fps);
+	void RenderDemo(HWND hWnd, HDC hdc, int height, int width, const FrameContext& frame);
 	void ResizeDemo(HWND hWnd, const RECT& rect);
 	void InitDemo(HWND hWnd, HDC hdc);
 
 private:
+	void DrawClock(const ClockHands& hands);
+
 	BITMAPINFO m_bmpInfo;
 	HDC m_bitmapDC;
 	void* m_bitmapData;
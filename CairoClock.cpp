@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "CairoClock.h"
+
+#include "CairoGlyphAtlas.h"
+#include "ClockGeometry.h"
+#include "ClockGrid.h"
+#include "RenderZones.h"
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include <cstdio>
+
+CairoScenePaints::CairoScenePaints()
+   : background(cairo_pattern_create_rgba(0.337, 0.612, 0.117, 0.9)),   // green
+   face(cairo_pattern_create_rgba(1.0, 1.0, 1.0, 0.8)),
+   secondHand(cairo_pattern_create_rgba(0.7, 0.7, 0.7, 0.8)),            // gray
+   minuteHand(cairo_pattern_create_rgba(0.117, 0.337, 0.612, 0.9)),      // blue
+   hourHand(cairo_pattern_create_rgba(0.337, 0.612, 0.117, 0.9)),        // green
+   lineCap(CAIRO_LINE_CAP_ROUND)
+{
+}
+
+CairoScenePaints::~CairoScenePaints()
+{
+   cairo_pattern_destroy(background);
+   cairo_pattern_destroy(face);
+   cairo_pattern_destroy(secondHand);
+   cairo_pattern_destroy(minuteHand);
+   cairo_pattern_destroy(hourHand);
+}
+
+/**
+  Sets pattern as the source if there is one, else the colour r, g, b, a.
+*/
+static void SetSource(cairo_t* cr, cairo_pattern_t* pattern, double r, double g, double b, double a)
+{
+   if (pattern)
+      cairo_set_source(cr, pattern);
+   else
+      cairo_set_source_rgba(cr, r, g, b, a);
+}
+
+void DrawCairoClock(cairo_t* cr, const ClockHands& hands, unsigned layers, const CairoScenePaints* paints)
+{
+   double m_radius = clockRadius;
+   double m_line_width = clockLineWidth;
+
+   cairo_set_line_width(cr, m_line_width);
+
+   // Clock face:
+   if (layers & e_StaticLayer)
+   {
+      RENDER_ZONE(e_PhaseFace);
+      cairo_save(cr);
+      cairo_new_sub_path(cr);
+      cairo_arc(cr, 0, 0, m_radius, 0, 2 * M_PI);
+      cairo_save(cr);
+      SetSource(cr, paints ? paints->face : 0, 1.0, 1.0, 1.0, 0.8);
+      cairo_fill_preserve(cr);
+      cairo_restore(cr);
+      cairo_close_path(cr);
+      cairo_stroke(cr);
+      cairo_restore(cr);
+   }
+
+   // clock ticks
+   if (layers & e_StaticLayer)
+   {
+      RENDER_ZONE(e_PhaseTicks);
+      for (int i = 0; i < 12; ++i)
+      {
+         double inset = 0.05;
+
+         cairo_save(cr);
+         if (!paints)
+            cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+
+         if (i % 3 != 0)
+         {
+            inset *= 0.8;
+            cairo_set_line_width(cr, 0.03);
+         }
+
+         const double angle = i * M_PI / 6.0f;
+         const double sinAngle = std::sin(angle);
+         const double cosAngle = std::cos(angle);
+
+         cairo_move_to(cr, (m_radius - inset) * cosAngle, (m_radius - inset) * sinAngle);
+         cairo_line_to (cr, m_radius * cosAngle, m_radius * sinAngle);
+         cairo_stroke(cr);
+         cairo_restore(cr); // stack-pen-size
+      }
+   }
+
+   if (layers & e_DynamicLayer)
+   {
+      RENDER_ZONE(e_PhaseHands);
+
+      cairo_save(cr);
+      if (!paints)
+         cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+
+      // draw the seconds hand
+      cairo_save(cr);
+      cairo_set_line_width(cr, secondHandWidth);
+      SetSource(cr, paints ? paints->secondHand : 0, 0.7, 0.7, 0.7, 0.8); // gray
+      cairo_move_to(cr, 0, 0);
+      double sinSec = std::sin(hands.seconds);
+      double cosSec = std::cos(hands.seconds);
+      cairo_line_to(cr, sinSec * secondHandLength, -cosSec * secondHandLength);
+      cairo_stroke(cr);
+      cairo_restore(cr);
+
+      // draw the minutes hand
+      SetSource(cr, paints ? paints->minuteHand : 0, 0.117, 0.337, 0.612, 0.9);   // blue
+      cairo_move_to(cr, 0, 0);
+      double sinMin = std::sin(hands.minutes);
+      double cosMin = std::cos(hands.minutes);
+      cairo_line_to(cr, sinMin * minuteHandLength, -cosMin * minuteHandLength);
+      cairo_stroke(cr);
+
+      // draw the hours hand
+      SetSource(cr, paints ? paints->hourHand : 0, 0.337, 0.612, 0.117, 0.9);   // green
+      cairo_move_to(cr, 0, 0);
+      double sinHours = std::sin(hands.hours);
+      double cosHours = std::cos(hands.hours);
+      cairo_line_to(cr, sinHours * hourHandLength, -cosHours * hourHandLength);
+      cairo_stroke(cr);
+      cairo_restore(cr);
+
+      // draw a little dot in the middle
+      cairo_arc(cr, 0, 0, m_line_width / 3.0, 0, 2 * M_PI);
+      cairo_fill(cr);
+      cairo_stroke(cr);
+   }
+}
+
+void DrawCairoClocks(cairo_t* cr, int width, int height, const FrameContext& frame, unsigned layers,
+                     const CairoScenePaints* paints)
+{
+   ClockGrid grid(width, height, frame.clocks);
+
+   // Skip the clocks that fall outside the target, e.g. when drawing a tile.
+   double clipLeft, clipTop, clipRight, clipBottom;
+   cairo_clip_extents(cr, &clipLeft, &clipTop, &clipRight, &clipBottom);
+
+   for (unsigned i = 0; i < grid.clocks(); ++i)
+   {
+      double x = grid.cellX(i);
+      double y = grid.cellY(i);
+      if (x >= clipRight || y >= clipBottom || x + grid.cellWidth() <= clipLeft || y + grid.cellHeight() <= clipTop)
+         continue;
+
+      cairo_save(cr);
+      cairo_translate(cr, x, y);
+      cairo_scale(cr, grid.cellWidth(), grid.cellHeight());
+      cairo_translate(cr, 0.5, 0.5);
+
+      DrawCairoClock(cr, (layers & e_DynamicLayer) ? frame.handsForClock(i) : frame.hands, layers, paints);
+
+      cairo_restore(cr);
+   }
+}
+
+void DrawCairoScene(cairo_t* cr, int width, int height, const FrameContext& frame, unsigned layers,
+                    const CairoScenePaints* paints, const CairoGlyphAtlas* labelGlyphs)
+{
+   if (paints)
+      cairo_set_line_cap(cr, paints->lineCap);
+
+   // Background
+   if (layers & e_StaticLayer)
+   {
+      RENDER_ZONE(e_PhaseBackground);
+      cairo_save(cr);
+      SetSource(cr, paints ? paints->background : 0, 0.337, 0.612, 0.117, 0.9);   // green
+      cairo_paint(cr);
+      cairo_restore(cr);
+   }
+
+   DrawCairoClocks(cr, width, height, frame, layers, paints);
+
+   // Display FPS:
+   if (layers & e_DynamicLayer)
+   {
+      RENDER_ZONE(e_PhaseText);
+
+      char message[100];
+      sprintf(message, "fps: %0.2g", frame.fps);
+
+      if (labelGlyphs)
+         labelGlyphs->draw(cr, 0, 10.0, message);
+      else
+      {
+         cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+         cairo_set_font_size(cr, 11.0);
+         cairo_move_to(cr, 0, 10.0);
+         cairo_show_text(cr, message);
+      }
+   }
+}
+
+void PlayCairoDisplayList(cairo_t* cr, ClockDisplayList& list, int width, int height, const FrameContext& frame)
+{
+   if (!list.matches(width, height, frame.clocks))
+      list.build(width, height, frame.clocks);
+
+   list.update(frame);
+
+   cairo_save(cr);
+   CairoDisplayListPlayer player(cr);
+   list.play(player);
+   cairo_restore(cr);
+}
+
+CairoDisplayListPlayer::CairoDisplayListPlayer(cairo_t* cr)
+   : m_cr(cr)
+{
+   cairo_set_line_cap(m_cr, CAIRO_LINE_CAP_ROUND);
+   cairo_select_font_face(m_cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+   cairo_set_font_size(m_cr, 11.0);
+}
+
+void CairoDisplayListPlayer::setTransform(const float matrix[6])
+{
+   cairo_matrix_t transform;
+   cairo_matrix_init(&transform, matrix[0], matrix[1], matrix[2], matrix[3], matrix[4], matrix[5]);
+   cairo_set_matrix(m_cr, &transform);
+}
+
+void CairoDisplayListPlayer::setColor(float r, float g, float b, float a)
+{
+   cairo_set_source_rgba(m_cr, r, g, b, a);
+}
+
+void CairoDisplayListPlayer::setLineWidth(float width)
+{
+   cairo_set_line_width(m_cr, width);
+}
+
+void CairoDisplayListPlayer::fillRect(float x, float y, float width, float height)
+{
+   cairo_rectangle(m_cr, x, y, width, height);
+   cairo_fill(m_cr);
+}
+
+void CairoDisplayListPlayer::fillCircle(float cx, float cy, float radius)
+{
+   cairo_new_sub_path(m_cr);
+   cairo_arc(m_cr, cx, cy, radius, 0, 2 * M_PI);
+   cairo_fill(m_cr);
+}
+
+void CairoDisplayListPlayer::strokeCircle(float cx, float cy, float radius)
+{
+   cairo_new_sub_path(m_cr);
+   cairo_arc(m_cr, cx, cy, radius, 0, 2 * M_PI);
+   cairo_close_path(m_cr);
+   cairo_stroke(m_cr);
+}
+
+void CairoDisplayListPlayer::strokeLine(float x0, float y0, float x1, float y1)
+{
+   cairo_move_to(m_cr, x0, y0);
+   cairo_line_to(m_cr, x1, y1);
+   cairo_stroke(m_cr);
+}
+
+void CairoDisplayListPlayer::text(float x, float y, float fps)
+{
+   cairo_move_to(m_cr, x, y);
+
+   char message[100];
+   sprintf(message, "fps: %0.2g", fps);
+   cairo_show_text(m_cr, message);
+}
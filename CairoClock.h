@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include "ClockDisplayList.h"
+#include "FrameContext.h"
+
+#include <cairo/cairo.h>
+
+class CairoGlyphAtlas;
+
+/**
+  The parts of the scene that never change between frames (background,
+  faces and ticks) and those that do (hands, centre dots and fps overlay).
+*/
+enum CairoSceneLayers
+{
+   e_StaticLayer = 1 << 0,
+   e_DynamicLayer = 1 << 1,
+   e_AllLayers = e_StaticLayer | e_DynamicLayer
+};
+
+/**
+  Solid patterns for every colour of the scene and the line cap, created
+  once like the brushes and stroke style of D2DRenderer. Without them each
+  cairo_set_source_rgba call creates, and later frees, a pattern.
+*/
+struct CairoScenePaints
+{
+   CairoScenePaints();
+   ~CairoScenePaints();
+
+   cairo_pattern_t* background;
+   cairo_pattern_t* face;
+   cairo_pattern_t* secondHand;
+   cairo_pattern_t* minuteHand;
+   cairo_pattern_t* hourHand;
+   cairo_line_cap_t lineCap;
+
+private:
+   CairoScenePaints(const CairoScenePaints&);
+   CairoScenePaints& operator=(const CairoScenePaints&);
+};
+
+/**
+  Draws the face, ticks and hands of one clock, or only those in layers. The
+  clock is centred on the origin and has a radius of 0.42, so the caller
+  scales a unit square onto the area it should cover. If paints are given,
+  their patterns are used and cr must already have their line cap.
+*/
+void DrawCairoClock(cairo_t* cr, const ClockHands& hands, unsigned layers = e_AllLayers,
+                    const CairoScenePaints* paints = 0);
+
+/**
+  Draws the frame.clocks clocks of the scene into a width x height target,
+  laid out by ClockGrid, each showing its own time.
+*/
+void DrawCairoClocks(cairo_t* cr, int width, int height, const FrameContext& frame, unsigned layers = e_AllLayers,
+                     const CairoScenePaints* paints = 0);
+
+/**
+  Draws a whole frame: the background, the clocks and the fps overlay, or
+  only the parts of it in layers. The current transformation of cr should
+  map frame pixels to device space. Optional paints replace the colours
+  set per draw, and their line cap is set on cr once. If labelGlyphs is
+  given, the fps overlay is drawn from that atlas instead of with
+  cairo_show_text.
+*/
+void DrawCairoScene(cairo_t* cr, int width, int height, const FrameContext& frame, unsigned layers = e_AllLayers,
+                    const CairoScenePaints* paints = 0, const CairoGlyphAtlas* labelGlyphs = 0);
+
+/**
+  Brings list up to date for the frame, rebuilding it if the size or the
+  scene changed, and replays it into cr. The state of cr is preserved.
+*/
+void PlayCairoDisplayList(cairo_t* cr, ClockDisplayList& list, int width, int height, const FrameContext& frame);
+
+/**
+  Replays a ClockDisplayList through cairo, with round line caps.
+*/
+class CairoDisplayListPlayer : public DisplayListPlayer
+{
+public:
+   explicit CairoDisplayListPlayer(cairo_t* cr);
+
+   virtual void setTransform(const float matrix[6]);
+   virtual void setColor(float r, float g, float b, float a);
+   virtual void setLineWidth(float width);
+   virtual void fillRect(float x, float y, float width, float height);
+   virtual void fillCircle(float cx, float cy, float radius);
+   virtual void strokeCircle(float cx, float cy, float radius);
+   virtual void strokeLine(float x0, float y0, float x1, float y1);
+   virtual void text(float x, float y, float fps);
+
+private:
+   cairo_t* m_cr;
+};
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "CairoCommandBuffer.h"
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include <cstdio>
+
+CairoCommandBuffer::CairoCommandBuffer()
+   : m_cr(0), m_pending(e_NoDraw), m_opaque(false)
+{
+   reset();
+}
+
+void CairoCommandBuffer::reset()
+{
+   m_frames = 0;
+   m_calls = 0;
+   m_unbatchedCalls = 0;
+   m_draws = 0;
+   m_unbatchedDraws = 0;
+}
+
+/**
+  Replays list into cr, whose state is preserved, and counts one frame.
+*/
+void CairoCommandBuffer::play(cairo_t* cr, const ClockDisplayList& list)
+{
+   m_cr = cr;
+   m_pending = e_NoDraw;
+   m_opaque = false;
+
+   cairo_save(m_cr);
+   cairo_set_line_cap(m_cr, CAIRO_LINE_CAP_ROUND);
+   cairo_select_font_face(m_cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+   cairo_set_font_size(m_cr, 11.0);
+
+   list.play(*this);
+   flush();
+
+   cairo_restore(m_cr);
+   m_cr = 0;
+   ++m_frames;
+}
+
+void CairoCommandBuffer::writeReport(FILE* out) const
+{
+   if (!m_frames)
+      return;
+
+   fprintf(out, "command buffer: %.1f cairo calls per frame instead of %.1f (%.1f saved), "
+                "%.1f fills and strokes instead of %.1f\n",
+           static_cast<double>(m_calls) / m_frames, static_cast<double>(m_unbatchedCalls) / m_frames,
+           static_cast<double>(m_unbatchedCalls - m_calls) / m_frames,
+           static_cast<double>(m_draws) / m_frames, static_cast<double>(m_unbatchedDraws) / m_frames);
+}
+
+/**
+  Ends the pending batch if the next draw is of another kind, and accounts
+  for the pathCalls calls that add the next draw to the path.
+*/
+void CairoCommandBuffer::begin(PendingDraw draw, unsigned pathCalls)
+{
+   if (m_pending != draw)
+      flush();
+
+   m_pending = draw;
+   m_calls += pathCalls;
+   m_unbatchedCalls += pathCalls + 1;
+   ++m_unbatchedDraws;
+}
+
+void CairoCommandBuffer::end()
+{
+   if (!m_opaque)
+      flush();
+}
+
+void CairoCommandBuffer::flush()
+{
+   if (m_pending == e_NoDraw)
+      return;
+
+   if (m_pending == e_PendingFill)
+      cairo_fill(m_cr);
+   else
+      cairo_stroke(m_cr);
+
+   m_pending = e_NoDraw;
+   ++m_calls;
+   ++m_draws;
+}
+
+void CairoCommandBuffer::setTransform(const float matrix[6])
+{
+   if (m_pending == e_PendingStroke)
+      flush();
+
+   cairo_matrix_t transform;
+   cairo_matrix_init(&transform, matrix[0], matrix[1], matrix[2], matrix[3], matrix[4], matrix[5]);
+   cairo_set_matrix(m_cr, &transform);
+   ++m_calls;
+   ++m_unbatchedCalls;
+}
+
+void CairoCommandBuffer::setColor(float r, float g, float b, float a)
+{
+   flush();
+
+   cairo_set_source_rgba(m_cr, r, g, b, a);
+   m_opaque = a >= 1.0f;
+   ++m_calls;
+   ++m_unbatchedCalls;
+}
+
+void CairoCommandBuffer::setLineWidth(float width)
+{
+   // Fills don't depend on the line width.
+   if (m_pending == e_PendingStroke)
+      flush();
+
+   cairo_set_line_width(m_cr, width);
+   ++m_calls;
+   ++m_unbatchedCalls;
+}
+
+void CairoCommandBuffer::fillRect(float x, float y, float width, float height)
+{
+   begin(e_PendingFill, 1);
+   cairo_rectangle(m_cr, x, y, width, height);
+   end();
+}
+
+void CairoCommandBuffer::fillCircle(float cx, float cy, float radius)
+{
+   begin(e_PendingFill, 2);
+   cairo_new_sub_path(m_cr);
+   cairo_arc(m_cr, cx, cy, radius, 0, 2 * M_PI);
+   end();
+}
+
+void CairoCommandBuffer::strokeCircle(float cx, float cy, float radius)
+{
+   begin(e_PendingStroke, 3);
+   cairo_new_sub_path(m_cr);
+   cairo_arc(m_cr, cx, cy, radius, 0, 2 * M_PI);
+   cairo_close_path(m_cr);
+   end();
+}
+
+void CairoCommandBuffer::strokeLine(float x0, float y0, float x1, float y1)
+{
+   begin(e_PendingStroke, 2);
+   cairo_move_to(m_cr, x0, y0);
+   cairo_line_to(m_cr, x1, y1);
+   end();
+}
+
+void CairoCommandBuffer::text(float x, float y, float fps)
+{
+   flush();
+
+   cairo_move_to(m_cr, x, y);
+
+   char message[100];
+   sprintf(message, "fps: %0.2g", fps);
+   cairo_show_text(m_cr, message);
+   m_calls += 2;
+   m_unbatchedCalls += 2;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include "ClockDisplayList.h"
+
+#include <cairo/cairo.h>
+
+#include <cstdio>
+
+/**
+  A DisplayListPlayer that sits in front of cairo and merges consecutive
+  draws of the same kind (fill or stroke) with identical state into one
+  path, so that they cost a single cairo_fill or cairo_stroke.
+
+  Merging is only exact for opaque colours, since a translucent path that
+  overlaps itself is blended once instead of twice; translucent draws are
+  issued one by one. A change of transform only ends a stroke batch, as
+  cairo keeps paths in device space but strokes with the current line width
+  in user space.
+
+  The buffer counts the cairo calls it makes and the calls replaying the
+  same list without merging would have made.
+*/
+class CairoCommandBuffer : public DisplayListPlayer
+{
+public:
+   CairoCommandBuffer();
+
+   void play(cairo_t* cr, const ClockDisplayList& list);
+
+   void reset();
+   void writeReport(FILE* out) const;
+
+   virtual void setTransform(const float matrix[6]);
+   virtual void setColor(float r, float g, float b, float a);
+   virtual void setLineWidth(float width);
+   virtual void fillRect(float x, float y, float width, float height);
+   virtual void fillCircle(float cx, float cy, float radius);
+   virtual void strokeCircle(float cx, float cy, float radius);
+   virtual void strokeLine(float x0, float y0, float x1, float y1);
+   virtual void text(float x, float y, float fps);
+
+private:
+   enum PendingDraw
+   {
+      e_NoDraw,
+      e_PendingFill,
+      e_PendingStroke
+   };
+
+   void begin(PendingDraw draw, unsigned pathCalls);
+   void end();
+   void flush();
+
+   cairo_t* m_cr;
+   PendingDraw m_pending;
+   bool m_opaque;
+
+   unsigned m_frames;
+   unsigned long long m_calls;
+   unsigned long long m_unbatchedCalls;
+   unsigned long long m_draws;
+   unsigned long long m_unbatchedDraws;
+};
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "CairoFrameCache.h"
+
+#include "ClockGeometry.h"
+#include "ClockGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#undef min
+#undef max
+
+// Not M_PI: <algorithm> may already have pulled in math.h without it.
+static const double pi = 3.14159265358979323846;
+
+CairoFrameCache::CairoFrameCache(size_t budgetBytes)
+   : m_budget(budgetBytes), m_bytes(0), m_hash(0), m_width(0), m_height(0)
+{
+   resetStatistics();
+}
+
+CairoFrameCache::~CairoFrameCache()
+{
+   clear();
+}
+
+void CairoFrameCache::setBudget(size_t budgetBytes)
+{
+   m_budget = budgetBytes;
+
+   while (m_bytes > m_budget)
+      evict();
+}
+
+void CairoFrameCache::clear()
+{
+   while (!m_entries.empty())
+      evict();
+}
+
+void CairoFrameCache::evict()
+{
+   Entry& entry = m_entries.back();
+   cairo_surface_destroy(entry.surface);
+   m_bytes -= entry.bytes;
+   m_entries.pop_back();
+   ++m_evictions;
+}
+
+void CairoFrameCache::resetStatistics()
+{
+   m_lookups = 0;
+   m_hits = 0;
+   m_evictions = 0;
+}
+
+/**
+  Index of angle in steps of step radians, wrapping at a full turn.
+*/
+static int QuantizeAngle(double angle, double step)
+{
+   const double turn = 2 * pi;
+   angle = std::fmod(angle, turn);
+   if (angle < 0.0)
+      angle += turn;
+
+   const int steps = static_cast<int>(std::ceil(turn / step));
+   return static_cast<int>(std::floor(angle / step + 0.5)) % steps;
+}
+
+cairo_surface_t* CairoFrameCache::lookup(int width, int height, const FrameContext& frame)
+{
+   ClockGrid grid(width, height, frame.clocks);
+
+   // Stretching maps the unit clock onto the larger cell side at most.
+   const double cellSize = std::max(grid.cellWidth(), grid.cellHeight());
+   const double lengths[e_HandCount] = { secondHandLength, minuteHandLength, hourHandLength };
+   double steps[e_HandCount];
+   for (int hand = 0; hand < e_HandCount; ++hand)
+      steps[hand] = 0.5 / std::max(lengths[hand] * cellSize, 0.5);
+
+   char label[100];
+   sprintf(label, "fps: %0.2g", frame.fps);
+
+   m_key.clear();
+   m_key.push_back(width);
+   m_key.push_back(height);
+   m_key.push_back(static_cast<int>(grid.clocks()));
+   for (const char* p = label; *p; ++p)
+      m_key.push_back(*p);
+
+   for (unsigned i = 0; i < grid.clocks(); ++i)
+   {
+      ClockHands hands = frame.handsForClock(i);
+      m_key.push_back(QuantizeAngle(hands.seconds, steps[e_SecondHand]));
+      m_key.push_back(QuantizeAngle(hands.minutes, steps[e_MinuteHand]));
+      m_key.push_back(QuantizeAngle(hands.hours, steps[e_HourHand]));
+   }
+
+   // FNV-1a, so most mismatches are rejected without comparing keys.
+   m_hash = 14695981039346656037ULL;
+   for (size_t i = 0; i < m_key.size(); ++i)
+   {
+      m_hash ^= static_cast<unsigned>(m_key[i]);
+      m_hash *= 1099511628211ULL;
+   }
+
+   m_width = width;
+   m_height = height;
+   ++m_lookups;
+
+   for (std::list<Entry>::iterator entry = m_entries.begin(); entry != m_entries.end(); ++entry)
+   {
+      if (entry->hash != m_hash || entry->key != m_key)
+         continue;
+
+      m_entries.splice(m_entries.begin(), m_entries, entry);
+      ++m_hits;
+      return m_entries.front().surface;
+   }
+
+   return 0;
+}
+
+cairo_surface_t* CairoFrameCache::insert(cairo_surface_t* target)
+{
+   const size_t bytes = static_cast<size_t>(m_width) * m_height * 4;
+   if (bytes > m_budget)
+      return 0;
+
+   while (m_bytes + bytes > m_budget)
+      evict();
+
+   Entry entry;
+   entry.key = m_key;
+   entry.hash = m_hash;
+   entry.surface = cairo_surface_create_similar(target, CAIRO_CONTENT_COLOR_ALPHA, m_width, m_height);
+   entry.bytes = bytes;
+
+   m_entries.push_front(entry);
+   m_bytes += bytes;
+   return entry.surface;
+}
+
+void CairoFrameCache::writeReport(FILE* out) const
+{
+   if (!m_lookups)
+      return;
+
+   fprintf(out, "frame cache: %.1f%% hits in %llu frames, %u frames cached (%.1f of %.1f MB), %llu evictions\n",
+           100.0 * m_hits / m_lookups, m_lookups, static_cast<unsigned>(m_entries.size()),
+           m_bytes / (1024.0 * 1024.0), m_budget / (1024.0 * 1024.0), m_evictions);
+}
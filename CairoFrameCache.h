@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include "FrameContext.h"
+
+#include <cairo/cairo.h>
+
+#include <cstdio>
+#include <list>
+#include <vector>
+
+/**
+  A least recently used cache of whole rendered frames.
+
+  Frames are keyed by the size, the fps label and every hand angle
+  quantized to the step that moves the tip of that hand by half a pixel at
+  the current cell size, so two frames with the same key look the same to
+  within half a pixel. Cached frames are kept in surfaces similar to the
+  target until they no longer fit the memory budget.
+*/
+class CairoFrameCache
+{
+public:
+   explicit CairoFrameCache(size_t budgetBytes);
+   ~CairoFrameCache();
+
+   void setBudget(size_t budgetBytes);
+   size_t budget() const { return m_budget; }
+
+   /**
+     Returns the cached rendering of frame at this size, or 0 on a miss.
+   */
+   cairo_surface_t* lookup(int width, int height, const FrameContext& frame);
+
+   /**
+     After a miss, returns a new surface similar to target to render the
+     missed frame into, which is then cached under its key. Returns 0 if a
+     single frame does not fit the budget.
+   */
+   cairo_surface_t* insert(cairo_surface_t* target);
+
+   void clear();
+
+   void resetStatistics();
+   void writeReport(FILE* out) const;
+
+private:
+   CairoFrameCache(const CairoFrameCache&);
+   CairoFrameCache& operator=(const CairoFrameCache&);
+
+   typedef std::vector<int> Key;
+
+   struct Entry
+   {
+      Key key;
+      unsigned long long hash;
+      cairo_surface_t* surface;
+      size_t bytes;
+   };
+
+   void evict();
+
+   size_t m_budget;
+   size_t m_bytes;
+   std::list<Entry> m_entries;   // most recently used first
+
+   // Key of the last lookup, and the size of its frame.
+   Key m_key;
+   unsigned long long m_hash;
+   int m_width;
+   int m_height;
+
+   unsigned long long m_lookups;
+   unsigned long long m_hits;
+   unsigned long long m_evictions;
+};
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "CairoGLOffscreen.h"
+
+#include "CairoClock.h"
+#include "CairoGlyphAtlas.h"
+#include "ClockDisplayList.h"
+#include "RenderZones.h"
+
+#include <cairo/cairo.h>
+#include <cairo/cairo-gl.h>
+
+#include <GL/gl.h>
+
+#include <cstdio>
+
+#pragma comment (lib, "cairo.lib")
+
+CairoGLOffscreenRenderer::CairoGLOffscreenRenderer(HWND hWnd, HDC hdc)
+   : m_device(0), m_surface(0), m_cr(0), m_width(0), m_height(0),
+   m_hglrc(0),
+   m_displayList(0), m_paints(0), m_labelGlyphs(0)
+{
+   InitDemo(hWnd, hdc);
+}
+
+CairoGLOffscreenRenderer::~CairoGLOffscreenRenderer()
+{
+   delete m_labelGlyphs;
+   cairo_destroy(m_cr);
+   cairo_surface_destroy(m_surface);
+   delete m_displayList;
+   delete m_paints;
+   DestroyContext();
+}
+
+bool CairoGLOffscreenRenderer::CreateContext(HDC hdc)
+{
+   m_hglrc = wglCreateContext(hdc);
+   if (!m_hglrc)
+   {
+      fprintf(stderr, "could not create a GL context (error %lu)\n", ::GetLastError());
+      return false;
+   }
+
+   m_device = cairo_wgl_device_create(m_hglrc);
+   return true;
+}
+
+void CairoGLOffscreenRenderer::DestroyContext()
+{
+   cairo_device_destroy(m_device);
+   m_device = 0;
+
+   if (m_hglrc)
+   {
+      if (wglGetCurrentContext() == m_hglrc)
+         wglMakeCurrent(0, 0);
+      wglDeleteContext(m_hglrc);
+      m_hglrc = 0;
+   }
+}
+
+void CairoGLOffscreenRenderer::InitDemo(HWND hWnd, HDC hdc)
+{
+   RECT rect;
+   ::GetClientRect(hWnd, &rect);
+
+   if (!CreateContext(hdc))
+      return;
+
+   if (cairo_device_status(m_device) != CAIRO_STATUS_SUCCESS)
+      fprintf(stderr, "cairo device failed with %s\n", cairo_status_to_string(cairo_device_status(m_device)));
+
+   CreateSurface(rect.right - rect.left, rect.bottom - rect.top);
+
+   if (!m_paints)
+      m_paints = new CairoScenePaints;
+   if (!m_labelGlyphs)
+      m_labelGlyphs = new CairoGlyphAtlas(m_surface, "Sans", 11.0);
+}
+
+/**
+  A texture of the given size with a framebuffer object cairo draws into.
+*/
+void CairoGLOffscreenRenderer::CreateSurface(int width, int height)
+{
+   cairo_destroy(m_cr);
+   cairo_surface_destroy(m_surface);
+
+   m_width = width;
+   m_height = height;
+
+   m_surface = cairo_gl_surface_create(m_device, CAIRO_CONTENT_COLOR_ALPHA, width, height);
+   if (cairo_surface_status(m_surface) != CAIRO_STATUS_SUCCESS)
+      fprintf(stderr, "cairo surface failed with %s\n", cairo_status_to_string(cairo_surface_status(m_surface)));
+
+   m_cr = cairo_create(m_surface);
+}
+
+bool CairoGLOffscreenRenderer::IsValid() const
+{
+   return m_device && cairo_device_status(m_device) == CAIRO_STATUS_SUCCESS
+      && cairo_surface_status(m_surface) == CAIRO_STATUS_SUCCESS;
+}
+
+bool CairoGLOffscreenRenderer::SetDisplayListMode(bool enabled)
+{
+   delete m_displayList;
+   m_displayList = enabled ? new ClockDisplayList : 0;
+   return true;
+}
+
+void CairoGLOffscreenRenderer::RenderDemo(HWND, HDC, int height, int width, const FrameContext& frame)
+{
+   if (width != m_width || height != m_height)
+      CreateSurface(width, height);
+
+   cairo_identity_matrix(m_cr);
+
+   if (m_displayList)
+      PlayCairoDisplayList(m_cr, *m_displayList, width, height, frame);
+   else
+      DrawCairoScene(m_cr, width, height, frame, e_AllLayers, m_paints,
+                     m_labelGlyphs->isValid() ? m_labelGlyphs : 0);
+
+   // Nothing is presented, so wait for GL to finish the frame; otherwise
+   // the driver could queue frames and the timing would only cover issuing
+   // the commands.
+   {
+      RENDER_ZONE(e_PhaseFlush);
+      cairo_surface_flush(m_surface);
+
+      if (cairo_device_acquire(m_device) == CAIRO_STATUS_SUCCESS)
+      {
+         glFinish();
+         cairo_device_release(m_device);
+      }
+   }
+
+   if (cairo_status(m_cr) != CAIRO_STATUS_SUCCESS)
+      printf("render failed with %s\n", cairo_status_to_string(cairo_status(m_cr)));
+}
+
+void CairoGLOffscreenRenderer::ResizeDemo(HWND, const RECT& rect)
+{
+   CreateSurface(rect.right - rect.left, rect.bottom - rect.top);
+}
+
+void CairoGLOffscreenRenderer::WriteStatistics(FILE* out)
+{
+   // Tells a software rasterizer (llvmpipe, softpipe) from a GPU driver.
+   if (cairo_device_acquire(m_device) != CAIRO_STATUS_SUCCESS)
+      return;
+
+   const GLubyte* renderer = glGetString(GL_RENDERER);
+   const GLubyte* version = glGetString(GL_VERSION);
+   fprintf(out, "GL renderer: %s, %s\n", renderer ? reinterpret_cast<const char*>(renderer) : "unknown",
+           version ? reinterpret_cast<const char*>(version) : "unknown");
+
+   cairo_device_release(m_device);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once;
+
+#include "IRenderTest.h"
+
+#include <cairo/cairo.h>
+
+class ClockDisplayList;
+class CairoGlyphAtlas;
+struct CairoScenePaints;
+
+/**
+  The CairoGL scene drawn into a texture through a framebuffer object
+  (cairo_gl_surface_create) instead of a window's back buffer, so nothing
+  is presented and no GPU is needed: with Mesa's software rasterizer as the
+  GL driver it measures the CPU cost of cairo's GL code path.
+
+  The bundled cairo only has WGL, so the context is still created on the
+  device context passed in, which must have a GL pixel format (the hidden
+  benchmark window's will do).
+*/
+class CairoGLOffscreenRenderer : public IRenderTest
+{
+public:
+	CairoGLOffscreenRenderer(HWND hWnd, HDC hdc);
+	virtual ~CairoGLOffscreenRenderer();
+
+	void RenderDemo(HWND hWnd, HDC hdc, int height, int width, const FrameContext& frame);
+	void ResizeDemo(HWND hWnd, const RECT& rect);
+	void InitDemo(HWND hWnd, HDC hdc);
+	void WriteStatistics(FILE* out);
+	bool SetDisplayListMode(bool enabled);
+
+	bool IsValid() const;
+
+private:
+	bool CreateContext(HDC hdc);
+	void DestroyContext();
+	void CreateSurface(int width, int height);
+
+	cairo_device_t* m_device;
+	cairo_surface_t* m_surface;
+	cairo_t* m_cr;
+	int m_width;
+	int m_height;
+	HGLRC m_hglrc;
+	ClockDisplayList* m_displayList;
+	CairoScenePaints* m_paints;
+	CairoGlyphAtlas* m_labelGlyphs;
+};
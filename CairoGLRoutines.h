@@ -28,15 +28,20 @@
 
 #include <cairo/cairo.h>
 
+class CairoGlyphAtlas;
+class ClockDisplayList;
+struct CairoScenePaints;
+
 class CairoGLRenderer : public IRenderTest
 {
 public:
 	CairoGLRenderer(HWND hWnd, HDC hdc);
 	virtual ~CairoGLRenderer();
 
-	void RenderDemo(HWND hWnd, HDC hdc, int height, int width, float fps);
+	void RenderDemo(HWND hWnd, HDC hdc, int height, int width, const FrameContext& frame);
 	void ResizeDemo(HWND hWnd, const RECT& rect);
 	void InitDemo(HWND hWnd, HDC hdc);
+	bool SetDisplayListMode(bool enabled);
 
 private:
 	cairo_device_t* m_device;
@@ -44,4 +49,7 @@ private:
 	cairo_t* m_cr;
 	HGLRC m_hglrc;
 	HDC m_hdc;
+	ClockDisplayList* m_displayList;
+	CairoScenePaints* m_paints;
+	CairoGlyphAtlas* m_labelGlyphs;
 };
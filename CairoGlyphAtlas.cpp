@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "CairoGlyphAtlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#undef min
+#undef max
+
+// Each character once: "inf"/"nan" from a C99 printf, "1.#INF"/"-1.#IND"
+// from the MSVC one.
+static const char atlasCharacters[] = "fps: 0123456789.+-einaIND#";
+
+// Room around each glyph for antialiasing that spills past its extents.
+static const int glyphPadding = 1;
+
+CairoGlyphAtlas::CairoGlyphAtlas(cairo_surface_t* target, const char* family, double size)
+   : m_atlas(0), m_spaceAdvance(0.0)
+{
+   memset(m_glyphs, 0, sizeof(m_glyphs));
+
+   // Measure with a scratch context first to size the atlas.
+   cairo_surface_t* scratch = cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1);
+   cairo_t* cr = cairo_create(scratch);
+   cairo_select_font_face(cr, family, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+   cairo_set_font_size(cr, size);
+
+   const size_t count = strlen(atlasCharacters);
+   cairo_text_extents_t extents[sizeof(atlasCharacters)];
+   int cellX[sizeof(atlasCharacters)];
+   int atlasWidth = 0;
+   int atlasHeight = 0;
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      char text[2] = { atlasCharacters[i], 0 };
+      cairo_text_extents(cr, text, &extents[i]);
+
+      cellX[i] = atlasWidth;
+      atlasWidth += static_cast<int>(std::ceil(extents[i].width)) + 2 * glyphPadding + 1;
+      atlasHeight = std::max(atlasHeight, static_cast<int>(std::ceil(extents[i].height)) + 2 * glyphPadding + 1);
+
+      if (atlasCharacters[i] == ' ')
+         m_spaceAdvance = extents[i].x_advance;
+   }
+
+   cairo_destroy(cr);
+   cairo_surface_destroy(scratch);
+
+   m_atlas = cairo_surface_create_similar(target, CAIRO_CONTENT_ALPHA, atlasWidth, atlasHeight);
+   if (cairo_surface_status(m_atlas) != CAIRO_STATUS_SUCCESS)
+   {
+      cairo_surface_destroy(m_atlas);
+      m_atlas = 0;
+      return;
+   }
+
+   cr = cairo_create(m_atlas);
+   cairo_select_font_face(cr, family, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+   cairo_set_font_size(cr, size);
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      const unsigned char c = static_cast<unsigned char>(atlasCharacters[i]);
+      const cairo_text_extents_t& e = extents[i];
+      const int cellWidth = static_cast<int>(std::ceil(e.width)) + 2 * glyphPadding + 1;
+      const int cellHeight = static_cast<int>(std::ceil(e.height)) + 2 * glyphPadding + 1;
+
+      Glyph& glyph = m_glyphs[c];
+      if (glyph.image)
+         continue;
+
+      glyph.advance = e.x_advance;
+
+      if (e.width <= 0.0 || e.height <= 0.0)
+         continue;
+
+      // Put the ink at a whole pixel offset inside the cell, so the glyph
+      // lands on the same pixel grid when it is blitted back.
+      glyph.left = std::floor(e.x_bearing) - glyphPadding;
+      glyph.top = std::floor(e.y_bearing) - glyphPadding;
+
+      char text[2] = { atlasCharacters[i], 0 };
+      cairo_move_to(cr, cellX[i] - glyph.left, -glyph.top);
+      cairo_show_text(cr, text);
+
+      glyph.image = cairo_surface_create_for_rectangle(m_atlas, cellX[i], 0, cellWidth, cellHeight);
+   }
+
+   cairo_destroy(cr);
+   cairo_surface_flush(m_atlas);
+}
+
+CairoGlyphAtlas::~CairoGlyphAtlas()
+{
+   for (int i = 0; i < 128; ++i)
+      cairo_surface_destroy(m_glyphs[i].image);
+
+   cairo_surface_destroy(m_atlas);
+}
+
+void CairoGlyphAtlas::draw(cairo_t* cr, double x, double y, const char* text) const
+{
+   double penX = std::floor(x + 0.5);
+   const double penY = std::floor(y + 0.5);
+
+   for (const char* p = text; *p; ++p)
+   {
+      const unsigned char c = static_cast<unsigned char>(*p);
+      const Glyph* glyph = c < 128 ? &m_glyphs[c] : 0;
+
+      if (!glyph || !glyph->advance)
+      {
+         penX += m_spaceAdvance;
+         continue;
+      }
+
+      if (glyph->image)
+         cairo_mask_surface(cr, glyph->image, std::floor(penX + 0.5) + glyph->left, penY + glyph->top);
+
+      penX += glyph->advance;
+   }
+}
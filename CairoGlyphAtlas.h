@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include <cairo/cairo.h>
+
+/**
+  The characters of the fps overlay ("fps: " and the digits, signs and
+  letters printf's %g can produce, MSVC's "1.#INF" included), rasterized
+  once into an alpha-only atlas surface.
+
+  Drawing a label then masks the current source with one sub-surface of
+  the atlas per character at whole pixel positions: no font lookup, no
+  shaping and no glyph cache traffic per frame. Characters missing from the
+  atlas advance like a space.
+*/
+class CairoGlyphAtlas
+{
+public:
+   /**
+     Rasterizes the glyphs with cairo's toy font API into a surface similar
+     to target, so the atlas lives where the frames are drawn (e.g. a GL
+     texture for cairo-gl).
+   */
+   CairoGlyphAtlas(cairo_surface_t* target, const char* family, double size);
+   ~CairoGlyphAtlas();
+
+   /**
+     Draws text with its baseline starting at (x, y) in user space of cr,
+     in the current source.
+   */
+   void draw(cairo_t* cr, double x, double y, const char* text) const;
+
+   bool isValid() const { return m_atlas != 0; }
+
+private:
+   CairoGlyphAtlas(const CairoGlyphAtlas&);
+   CairoGlyphAtlas& operator=(const CairoGlyphAtlas&);
+
+   struct Glyph
+   {
+      cairo_surface_t* image;   // sub-surface of m_atlas, 0 if not in the atlas
+      double left;               // offset of image from the pen position
+      double top;
+      double advance;
+   };
+
+   cairo_surface_t* m_atlas;
+   Glyph m_glyphs[128];
+   double m_spaceAdvance;
+};
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "CairoImageRenderer.h"
+
+#include "CairoClock.h"
+#include "ClockDisplayList.h"
+#include "RenderZones.h"
+
+#include <cairo/cairo.h>
+
+#include <cstdio>
+
+#pragma comment (lib, "cairo.lib")
+
+CairoImageRenderer::CairoImageRenderer(int width, int height, cairo_format_t format, int stride)
+   : m_format(format), m_requestedStride(stride), m_surface(0), m_cr(0), m_width(0), m_height(0), m_displayList(0)
+{
+   Resize(width, height);
+}
+
+CairoImageRenderer::~CairoImageRenderer()
+{
+   cairo_destroy(m_cr);
+   cairo_surface_destroy(m_surface);
+   delete m_displayList;
+}
+
+void CairoImageRenderer::InitDemo(HWND, HDC)
+{
+}
+
+/**
+  (Re)creates the image and its context. The requested stride is kept as
+  long as it holds a row; otherwise the rows are packed.
+*/
+void CairoImageRenderer::Resize(int width, int height)
+{
+   cairo_destroy(m_cr);
+   cairo_surface_destroy(m_surface);
+
+   m_width = width;
+   m_height = height;
+
+   int stride = cairo_format_stride_for_width(m_format, width);
+   if (m_requestedStride >= stride)
+      stride = m_requestedStride;
+
+   m_pixels.assign(static_cast<size_t>(stride) * height, 0);
+   m_surface = cairo_image_surface_create_for_data(m_pixels.empty() ? 0 : &m_pixels[0], m_format, width, height, stride);
+   if (cairo_surface_status(m_surface) != CAIRO_STATUS_SUCCESS)
+      fprintf(stderr, "cairo image surface failed with %s\n", cairo_status_to_string(cairo_surface_status(m_surface)));
+
+   m_cr = cairo_create(m_surface);
+}
+
+void CairoImageRenderer::ResizeDemo(HWND, const RECT& rect)
+{
+   Resize(rect.right - rect.left, rect.bottom - rect.top);
+}
+
+bool CairoImageRenderer::SetDisplayListMode(bool enabled)
+{
+   delete m_displayList;
+   m_displayList = enabled ? new ClockDisplayList : 0;
+   return true;
+}
+
+bool CairoImageRenderer::IsValid() const
+{
+   return cairo_surface_status(m_surface) == CAIRO_STATUS_SUCCESS;
+}
+
+void CairoImageRenderer::RenderDemo(HWND, HDC, int height, int width, const FrameContext& frame)
+{
+   if (width != m_width || height != m_height)
+      Resize(width, height);
+
+   cairo_identity_matrix(m_cr);
+
+   if (m_displayList)
+      PlayCairoDisplayList(m_cr, *m_displayList, width, height, frame);
+   else
+      DrawCairoScene(m_cr, width, height, frame);
+
+   {
+      RENDER_ZONE(e_PhaseFlush);
+      cairo_surface_flush(m_surface);
+   }
+}
+
+PixelBufferView CairoImageRenderer::Pixels() const
+{
+   return PixelBufferView::fromCairoImageSurface(m_surface);
+}
+
+bool CairoImageRenderer::WriteToPNG(const char* path) const
+{
+   return cairo_surface_write_to_png(m_surface, path) == CAIRO_STATUS_SUCCESS;
+}
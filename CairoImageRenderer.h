@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once;
+
+#include "IRenderTest.h"
+#include "PixelBufferView.h"
+
+#include <cairo/cairo.h>
+
+#include <vector>
+
+class ClockDisplayList;
+
+/**
+  Draws the clock scene into a cairo image surface in memory, without a
+  window, device context or GPU. The format and the row stride are chosen
+  by the caller (a stride of 0 packs the rows), and the finished pixels can
+  be read through Pixels() after each frame. The window and device context
+  arguments of IRenderTest are ignored; the image follows the size passed
+  to RenderDemo.
+*/
+class CairoImageRenderer : public IRenderTest
+{
+public:
+	CairoImageRenderer(int width, int height, cairo_format_t format = CAIRO_FORMAT_ARGB32, int stride = 0);
+	virtual ~CairoImageRenderer();
+
+	void RenderDemo(HWND hWnd, HDC hdc, int height, int width, const FrameContext& frame);
+	void ResizeDemo(HWND hWnd, const RECT& rect);
+	void InitDemo(HWND hWnd, HDC hdc);
+	bool SetDisplayListMode(bool enabled);
+
+	bool IsValid() const;
+
+	// The image surface drawn into, and a view of its pixels.
+	cairo_surface_t* Surface() const { return m_surface; }
+	PixelBufferView Pixels() const;
+
+	bool WriteToPNG(const char* path) const;
+
+private:
+	void Resize(int width, int height);
+
+	cairo_format_t m_format;
+	int m_requestedStride;
+	std::vector<unsigned char> m_pixels;
+	cairo_surface_t* m_surface;
+	cairo_t* m_cr;
+	int m_width;
+	int m_height;
+	ClockDisplayList* m_displayList;
+};
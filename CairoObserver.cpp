@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "CairoObserver.h"
+
+static const char* operationNames[] =
+{
+   "paint",
+   "mask",
+   "fill",
+   "stroke",
+   "glyphs"
+};
+
+CairoObserver::CairoObserver()
+   : m_observer(0)
+{
+   reset();
+}
+
+CairoObserver::~CairoObserver()
+{
+   cairo_surface_destroy(m_observer);
+}
+
+cairo_surface_t* CairoObserver::observe(cairo_surface_t* target)
+{
+   cairo_surface_destroy(m_observer);
+
+   m_observer = cairo_surface_create_observer(target, CAIRO_SURFACE_OBSERVER_NORMAL);
+   if (cairo_surface_status(m_observer) != CAIRO_STATUS_SUCCESS)
+      printf("cairo observer failed with %s\n", cairo_status_to_string(cairo_surface_status(m_observer)));
+
+   cairo_surface_observer_add_paint_callback(m_observer, paintCallback, this);
+   cairo_surface_observer_add_mask_callback(m_observer, maskCallback, this);
+   cairo_surface_observer_add_fill_callback(m_observer, fillCallback, this);
+   cairo_surface_observer_add_stroke_callback(m_observer, strokeCallback, this);
+   cairo_surface_observer_add_glyphs_callback(m_observer, glyphsCallback, this);
+
+   m_lastElapsed = 0.0;
+   return m_observer;
+}
+
+void CairoObserver::reset()
+{
+   m_lastElapsed = m_observer ? cairo_surface_observer_elapsed(m_observer) : 0.0;
+   m_frames = 0;
+
+   for (int i = 0; i < e_OperationCount; ++i)
+   {
+      m_counts[i] = 0;
+      m_elapsed[i] = 0.0;
+   }
+}
+
+void CairoObserver::endFrame()
+{
+   ++m_frames;
+}
+
+void CairoObserver::paintCallback(cairo_surface_t*, cairo_surface_t*, void* data)
+{
+   static_cast<CairoObserver*>(data)->operationCompleted(e_OperationPaint);
+}
+
+void CairoObserver::maskCallback(cairo_surface_t*, cairo_surface_t*, void* data)
+{
+   static_cast<CairoObserver*>(data)->operationCompleted(e_OperationMask);
+}
+
+void CairoObserver::fillCallback(cairo_surface_t*, cairo_surface_t*, void* data)
+{
+   static_cast<CairoObserver*>(data)->operationCompleted(e_OperationFill);
+}
+
+void CairoObserver::strokeCallback(cairo_surface_t*, cairo_surface_t*, void* data)
+{
+   static_cast<CairoObserver*>(data)->operationCompleted(e_OperationStroke);
+}
+
+void CairoObserver::glyphsCallback(cairo_surface_t*, cairo_surface_t*, void* data)
+{
+   static_cast<CairoObserver*>(data)->operationCompleted(e_OperationGlyphs);
+}
+
+void CairoObserver::operationCompleted(Operation operation)
+{
+   double elapsed = cairo_surface_observer_elapsed(m_observer);
+
+   ++m_counts[operation];
+   m_elapsed[operation] += elapsed - m_lastElapsed;
+   m_lastElapsed = elapsed;
+}
+
+void CairoObserver::writeReport(FILE* out) const
+{
+   if (!m_frames)
+      return;
+
+   double totalElapsed = 0.0;
+   for (int i = 0; i < e_OperationCount; ++i)
+      totalElapsed += m_elapsed[i];
+
+   const double nsPerMicrosecond = 1000.0;
+
+   fprintf(out, "%-10s %12s %12s %12s %7s\n", "operation", "calls/frame", "us/call", "us/frame", "share");
+   for (int i = 0; i < e_OperationCount; ++i)
+   {
+      fprintf(out, "%-10s %12.2f %12.3f %12.3f %6.1f%%\n", operationNames[i],
+              static_cast<double>(m_counts[i]) / m_frames,
+              m_counts[i] ? m_elapsed[i] / m_counts[i] / nsPerMicrosecond : 0.0,
+              m_elapsed[i] / m_frames / nsPerMicrosecond,
+              totalElapsed > 0.0 ? 100.0 * m_elapsed[i] / totalElapsed : 0.0);
+   }
+}
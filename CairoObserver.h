@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include <cairo/cairo.h>
+
+#include <cstdio>
+
+/**
+  Wraps a cairo surface in an observer surface and attributes the backend
+  time reported by cairo to each kind of drawing operation.
+
+  The observer callbacks run right after the wrapped operation completes, so
+  the growth of cairo_surface_observer_elapsed() since the previous callback
+  is exactly the time the target spent on that one operation.
+*/
+class CairoObserver
+{
+public:
+   CairoObserver();
+   ~CairoObserver();
+
+   /**
+     Returns a new observer surface drawing into target. Any previously
+     observed surface is released, but the statistics are kept.
+   */
+   cairo_surface_t* observe(cairo_surface_t* target);
+
+   void endFrame();
+   void reset();
+
+   void writeReport(FILE*) const;
+
+private:
+   enum Operation
+   {
+      e_OperationPaint,
+      e_OperationMask,
+      e_OperationFill,
+      e_OperationStroke,
+      e_OperationGlyphs,
+      e_OperationCount
+   };
+
+   static void paintCallback(cairo_surface_t*, cairo_surface_t*, void*);
+   static void maskCallback(cairo_surface_t*, cairo_surface_t*, void*);
+   static void fillCallback(cairo_surface_t*, cairo_surface_t*, void*);
+   static void strokeCallback(cairo_surface_t*, cairo_surface_t*, void*);
+   static void glyphsCallback(cairo_surface_t*, cairo_surface_t*, void*);
+
+   void operationCompleted(Operation);
+
+   cairo_surface_t* m_observer;
+   double m_lastElapsed;
+   unsigned m_frames;
+   unsigned long long m_counts[e_OperationCount];
+   double m_elapsed[e_OperationCount];   // nanoseconds
+};
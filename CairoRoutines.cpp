@@ -27,6 +27,19 @@
 
 #include "CairoRoutines.h"
 
+#include "CairoClock.h"
+#include "CairoCommandBuffer.h"
+#include "CairoFrameCache.h"
+#include "CairoGlyphAtlas.h"
+#include "CairoObserver.h"
+#include "CairoScriptTrace.h"
+#include "CairoTiles.h"
+#include "ClockDisplayList.h"
+#include "ClockGeometry.h"
+#include "ClockGrid.h"
+#include "RenderZones.h"
+#include "WorkerPool.h"
+
 #include <cairo/cairo.h>
 #include <cairo/cairo-win32.h>
 
@@ -36,10 +49,42 @@
 #include <cmath>
 
 #include <cstdio>
+#include <vector>
 
 #pragma comment (lib, "cairo.lib")
 
-CairoRenderer::CairoRenderer(HWND hWnd, HDC hdc) : m_surface(0), m_cr(0), m_hdc(0)
+static const size_t defaultFrameCacheBudget = 64 * 1024 * 1024;
+
+// Modes that each pick a separate drawing path in RenderDemo.
+static const unsigned drawingPathFlags = e_CairoTiles | e_CairoDamage | e_CairoLayers | e_CairoFrameCache
+   | e_CairoRecord | e_CairoRecordFrame | e_CairoBatch;
+
+/**
+  True if RenderDemo honours every mode in flags, with or without a display
+  list: it takes one drawing path per frame, all but batch are checked
+  before the display list, and only the paths that go through
+  DrawCairoScene use the pre-created paints and the glyph atlas.
+*/
+static bool CanHonourRenderFlags(unsigned flags, bool displayList)
+{
+   const unsigned paths = flags & drawingPathFlags;
+   if (paths & (paths - 1))
+      return false;
+
+   if (displayList && (paths & ~e_CairoBatch))
+      return false;
+
+   const bool drawsScene = !displayList && !(paths & (e_CairoTiles | e_CairoBatch));
+   return drawsScene || !(flags & (e_CairoPatterns | e_CairoGlyphAtlas));
+}
+
+CairoRenderer::CairoRenderer(HWND hWnd, HDC hdc) : m_surface(0), m_cr(0), m_hdc(0), m_flags(0), m_observer(0), m_capture(0),
+   m_threads(WorkerPool::hardwareThreads()), m_pool(0), m_tiles(0),
+   m_staticLayer(0), m_staticWidth(0), m_staticHeight(0), m_staticClocks(0), m_staticOpaque(false),
+   m_previousHands(0), m_damageFrames(0), m_damageRatioSum(0.0), m_damageRatioMax(0.0),
+   m_displayList(0), m_commandBuffer(0), m_paints(0),
+   m_labelGlyphs(0), m_frameCache(0), m_frameCacheBudget(defaultFrameCacheBudget),
+   m_recording(0), m_recordedWidth(0), m_recordedHeight(0), m_recordedClocks(0)
 {
    InitDemo(hWnd, hdc);
 }
@@ -47,6 +92,17 @@ CairoRenderer::CairoRenderer(HWND hWnd, HDC hdc) : m_surface(0), m_cr(0), m_hdc(
 CairoRenderer::~CairoRenderer()
 {
    cairo_destroy(m_cr);
+   InvalidateStaticLayer();
+   delete m_tiles;
+   delete m_pool;
+   delete m_observer;
+   delete m_capture;
+   delete m_displayList;
+   delete m_commandBuffer;
+   delete m_paints;
+   delete m_labelGlyphs;
+   delete m_frameCache;
+   cairo_surface_destroy(m_recording);
    cairo_surface_destroy(m_surface);
 }
 
@@ -54,7 +110,147 @@ void CairoRenderer::InitDemo(HWND hWnd, HDC hdc)
 {
    m_hdc = hdc;
    m_surface = cairo_win32_surface_create (hdc);
-   m_cr = cairo_create (m_surface);
+   CreateContext();
+
+   if (!m_paints)
+      m_paints = new CairoScenePaints;
+   if (!m_labelGlyphs)
+      m_labelGlyphs = new CairoGlyphAtlas(m_surface, "Sans", 11.0);
+}
+
+void CairoRenderer::SetFrameCacheBudget(size_t bytes)
+{
+   m_frameCacheBudget = bytes;
+
+   if (m_frameCache)
+      m_frameCache->setBudget(bytes);
+}
+
+/**
+  The pre-created paints in e_CairoPatterns mode, else 0 to set the colours
+  per draw.
+*/
+const CairoScenePaints* CairoRenderer::ScenePaints() const
+{
+   return (m_flags & e_CairoPatterns) ? m_paints : 0;
+}
+
+/**
+  The fps overlay atlas in e_CairoGlyphAtlas mode, else 0 to draw the
+  overlay with cairo_show_text.
+*/
+const CairoGlyphAtlas* CairoRenderer::LabelGlyphs() const
+{
+   return (m_flags & e_CairoGlyphAtlas) && m_labelGlyphs->isValid() ? m_labelGlyphs : 0;
+}
+
+bool CairoRenderer::SetRenderFlags(unsigned flags)
+{
+   if (!CanHonourRenderFlags(flags, m_displayList != 0))
+      return false;
+
+   m_flags = flags;
+   CreateContext();
+   return true;
+}
+
+void CairoRenderer::SetThreads(unsigned threads)
+{
+   m_threads = threads ? threads : WorkerPool::hardwareThreads();
+
+   delete m_pool;
+   m_pool = 0;
+}
+
+bool CairoRenderer::SetDisplayListMode(bool enabled)
+{
+   if (enabled && !CanHonourRenderFlags(m_flags, true))
+      return false;
+
+   delete m_displayList;
+   m_displayList = enabled ? new ClockDisplayList : 0;
+   return true;
+}
+
+/**
+  (Re)creates m_cr on m_surface, interposing an observer surface and the
+  trace capture if requested.
+*/
+void CairoRenderer::CreateContext()
+{
+   cairo_destroy(m_cr);
+
+   cairo_surface_t* target = m_surface;
+
+   if (m_flags & e_CairoObserve)
+   {
+      if (!m_observer)
+         m_observer = new CairoObserver;
+
+      target = m_observer->observe(target);
+   }
+
+   if (m_capture)
+      target = m_capture->capture(target);
+
+   m_cr = cairo_create(target);
+}
+
+bool CairoRenderer::SetScriptCapture(const char* path)
+{
+   // The context must stop drawing into the old trace before it is closed.
+   cairo_destroy(m_cr);
+   m_cr = 0;
+
+   delete m_capture;
+   m_capture = 0;
+
+   if (path)
+   {
+      m_capture = new CairoScriptCapture;
+      if (!m_capture->open(path))
+      {
+         delete m_capture;
+         m_capture = 0;
+      }
+   }
+
+   CreateContext();
+   return !path || m_capture;
+}
+
+void CairoRenderer::ResetStatistics()
+{
+   if (m_observer)
+      m_observer->reset();
+
+   m_damageFrames = 0;
+   m_damageRatioSum = 0.0;
+   m_damageRatioMax = 0.0;
+
+   if (m_commandBuffer)
+      m_commandBuffer->reset();
+
+   if (m_frameCache)
+      m_frameCache->resetStatistics();
+}
+
+void CairoRenderer::WriteStatistics(FILE* out)
+{
+   if (m_observer && (m_flags & e_CairoObserve))
+      m_observer->writeReport(out);
+
+   if (m_damageFrames && (m_flags & e_CairoDamage))
+   {
+      fprintf(out, "damaged pixels: mean %.3f%% max %.3f%% of the target per frame\n",
+              100.0 * m_damageRatioSum / m_damageFrames, 100.0 * m_damageRatioMax);
+   }
+
+   if (m_commandBuffer && (m_flags & e_CairoBatch))
+      m_commandBuffer->writeReport(out);
+
+   if (m_frameCache && (m_flags & e_CairoFrameCache))
+      m_frameCache->writeReport(out);
 }
 
 /**
@@ -100,125 +296,344 @@ LRESULT PaintCairoDemo(HDC hdc)
    return 0;
 }
 
-void CairoRenderer::RenderDemo(HWND hWnd, HDC hdc, int height, int width, float fps)
+void CairoRenderer::RenderDemo(HWND hWnd, HDC hdc, int height, int width, const FrameContext& frame)
 {
    cairo_identity_matrix(m_cr);
 
-   cairo_save(m_cr);
+   if (m_flags & e_CairoTiles)
+      RenderTiles(height, width, frame);
+   else if (m_flags & e_CairoDamage)
+      RenderDamage(height, width, frame);
+   else if (m_flags & e_CairoLayers)
+      RenderLayers(height, width, frame);
+   else if (m_flags & e_CairoFrameCache)
+      RenderFrameCache(height, width, frame);
+   else if (m_flags & (e_CairoRecord | e_CairoRecordFrame))
+      RenderRecording(height, width, frame);
+   else if (m_displayList || (m_flags & e_CairoBatch))
+      RenderDisplayList(height, width, frame);
+   else
+      DrawCairoScene(m_cr, width, height, frame, e_AllLayers, ScenePaints(), LabelGlyphs());
 
-   double m_radius = 0.42;
-   double m_line_width = 0.05;
+   {
+      RENDER_ZONE(e_PhaseFlush);
+      cairo_surface_flush(cairo_get_target(m_cr));
+   }
 
-   cairo_scale(m_cr, width, height);
-   cairo_translate(m_cr, 0.5, 0.5);
+   if (m_capture)
+      m_capture->endFrame(m_cr);
 
-   cairo_set_line_width(m_cr, m_line_width);
+   if (m_observer && (m_flags & e_CairoObserve))
+      m_observer->endFrame();
 
-   // Background
-   cairo_save(m_cr);
-   cairo_set_source_rgba(m_cr, 0.337, 0.612, 0.117, 0.9);   // green
-   cairo_paint(m_cr);
-   cairo_restore(m_cr);
+   if (cairo_status(m_cr) != CAIRO_STATUS_SUCCESS)
+      printf("render failed with %s\n", cairo_status_to_string(cairo_status(m_cr)));
+}
 
-   // Clock face:
-   cairo_save(m_cr);
-   cairo_new_sub_path(m_cr);
-   cairo_arc(m_cr, 0, 0, m_radius, 0, 2 * M_PI);
-   cairo_save(m_cr);
-   cairo_set_source_rgba(m_cr, 1.0, 1.0, 1.0, 0.8);
-   cairo_fill_preserve(m_cr);
-   cairo_restore(m_cr);
-   cairo_close_path(m_cr);
-   cairo_stroke(m_cr);
-   cairo_restore(m_cr);
+/**
+  Draws the frame into tiles on the worker pool, then copies the finished
+  frame to the window surface.
+*/
+void CairoRenderer::RenderTiles(int height, int width, const FrameContext& frame)
+{
+   if (!m_pool)
+      m_pool = new WorkerPool(m_threads);
+   if (!m_tiles)
+      m_tiles = new CairoTileSet;
+
+   // Zones only measure the calling thread, which would give a partial
+   // picture of the tiles it happened to pick up; leave that time untracked.
+   RenderPhaseStatistics* statistics = RenderPhaseStatistics::current();
+   RenderPhaseStatistics::setCurrent(0);
+   m_tiles->render(*m_pool, width, height, frame);
+   RenderPhaseStatistics::setCurrent(statistics);
 
-   // clock ticks
-   for (int i = 0; i < 12; ++i)
    {
-      double inset = 0.05;
+      RENDER_ZONE(e_PhaseFlush);
+      cairo_save(m_cr);
+      cairo_set_operator(m_cr, CAIRO_OPERATOR_SOURCE);
+      cairo_set_source_surface(m_cr, m_tiles->image(), 0, 0);
+      cairo_paint(m_cr);
+      cairo_restore(m_cr);
+   }
+}
+
+/**
+  Replays the scene from m_displayList, through the command buffer in
+  e_CairoBatch mode (which implies a display list).
+*/
+void CairoRenderer::RenderDisplayList(int height, int width, const FrameContext& frame)
+{
+   if (!m_displayList)
+      m_displayList = new ClockDisplayList;
 
+   if (!(m_flags & e_CairoBatch))
+   {
+      PlayCairoDisplayList(m_cr, *m_displayList, width, height, frame);
+      return;
+   }
+
+   if (!m_commandBuffer)
+      m_commandBuffer = new CairoCommandBuffer;
+
+   if (!m_displayList->matches(width, height, frame.clocks))
+      m_displayList->build(width, height, frame.clocks);
+
+   m_displayList->update(frame);
+   m_commandBuffer->play(m_cr, *m_displayList);
+}
+
+/**
+  Composites a cached rendering of the frame if one is close enough, else
+  renders the frame into a new cache entry first.
+*/
+void CairoRenderer::RenderFrameCache(int height, int width, const FrameContext& frame)
+{
+   if (!m_frameCache)
+      m_frameCache = new CairoFrameCache(m_frameCacheBudget);
+
+   cairo_surface_t* cached = m_frameCache->lookup(width, height, frame);
+   if (!cached)
+   {
+      cached = m_frameCache->insert(m_surface);
+      if (!cached)
+      {
+         DrawCairoScene(m_cr, width, height, frame, e_AllLayers, ScenePaints(), LabelGlyphs());
+         return;
+      }
+
+      cairo_t* cr = cairo_create(cached);
+      DrawCairoScene(cr, width, height, frame, e_AllLayers, ScenePaints(), LabelGlyphs());
+      cairo_destroy(cr);
+   }
+
+   // The cached frame starts out transparent, so blending it over the
+   // previous frame gives the same pixels as drawing the scene there.
+   {
+      RENDER_ZONE(e_PhaseBackground);
       cairo_save(m_cr);
-      cairo_set_line_cap(m_cr, CAIRO_LINE_CAP_ROUND);
+      cairo_set_source_surface(m_cr, cached, 0, 0);
+      cairo_paint(m_cr);
+      cairo_restore(m_cr);
+   }
+}
+
+/**
+  Replays recorded drawing commands instead of issuing them live. With
+  e_CairoRecordFrame the whole frame is recorded and replayed every frame,
+  which shows what recording costs; otherwise the static part of the scene
+  is recorded once per size and clock count, and only the hands and fps
+  overlay are drawn live on top of its replay.
+*/
+void CairoRenderer::RenderRecording(int height, int width, const FrameContext& frame)
+{
+   cairo_rectangle_t extents = { 0, 0, static_cast<double>(width), static_cast<double>(height) };
+
+   if (m_flags & e_CairoRecordFrame)
+   {
+      cairo_surface_t* recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents);
+      cairo_t* cr = cairo_create(recording);
+      DrawCairoScene(cr, width, height, frame, e_AllLayers, ScenePaints(), LabelGlyphs());
+      cairo_destroy(cr);
 
-      if (i % 3 != 0)
       {
-         inset *= 0.8;
-         cairo_set_line_width(m_cr, 0.03);
+         RENDER_ZONE(e_PhaseFlush);
+         cairo_save(m_cr);
+         cairo_set_source_surface(m_cr, recording, 0, 0);
+         cairo_paint(m_cr);
+         cairo_restore(m_cr);
       }
 
-      const double angle = i * M_PI / 6.0f;
-      const double sinAngle = std::sin(angle);
-      const double cosAngle = std::cos(angle);
+      cairo_surface_destroy(recording);
+      return;
+   }
 
-      cairo_move_to(m_cr, (m_radius - inset) * cosAngle, (m_radius - inset) * sinAngle);
-      cairo_line_to (m_cr, m_radius * cosAngle, m_radius * sinAngle);
-      cairo_stroke(m_cr);
-      cairo_restore(m_cr); // stack-pen-size
+   if (m_recording && (width != m_recordedWidth || height != m_recordedHeight || frame.clocks != m_recordedClocks))
+   {
+      cairo_surface_destroy(m_recording);
+      m_recording = 0;
    }
 
-   // store the current time
-   SYSTEMTIME time;
-   GetLocalTime(&time);
+   if (!m_recording)
+   {
+      m_recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents);
+      m_recordedWidth = width;
+      m_recordedHeight = height;
+      m_recordedClocks = frame.clocks;
+
+      cairo_t* cr = cairo_create(m_recording);
+      DrawCairoScene(cr, width, height, frame, e_StaticLayer, ScenePaints());
+      cairo_destroy(cr);
+   }
 
-   // compute the angles of the indicators of our clock
-   double minutes = time.wMinute * M_PI / 30;
-   double hours = time.wHour * M_PI / 6;
-   double seconds= ((double)time.wSecond + (double)time.wMilliseconds / 1000) * M_PI / 30;
+   // Painting a recording surface replays its commands onto the target,
+   // which gives the same pixels as drawing them directly.
+   {
+      RENDER_ZONE(e_PhaseBackground);
+      cairo_save(m_cr);
+      cairo_set_source_surface(m_cr, m_recording, 0, 0);
+      cairo_paint(m_cr);
+      cairo_restore(m_cr);
+   }
 
-   cairo_save(m_cr);
-   cairo_set_line_cap(m_cr, CAIRO_LINE_CAP_ROUND);
+   DrawCairoScene(m_cr, width, height, frame, e_DynamicLayer, ScenePaints(), LabelGlyphs());
+}
 
-   // draw the seconds hand
-   cairo_save(m_cr);
-   cairo_set_line_width(m_cr, m_line_width / 3);
-   cairo_set_source_rgba(m_cr, 0.7, 0.7, 0.7, 0.8); // gray
-   cairo_move_to(m_cr, 0, 0);
-	double secondHandLength = 0.9 * m_radius;
-	double sinSec = std::sin(seconds);
-	double cosSec = std::cos(seconds);
-   cairo_line_to(m_cr, sinSec * secondHandLength, -cosSec * secondHandLength);
-   cairo_stroke(m_cr);
-   cairo_restore(m_cr);
+void CairoRenderer::InvalidateStaticLayer()
+{
+   cairo_surface_destroy(m_staticLayer);
+   m_staticLayer = 0;
 
-   // draw the minutes hand
-   cairo_set_source_rgba(m_cr, 0.117, 0.337, 0.612, 0.9);   // blue
-   cairo_move_to(m_cr, 0, 0);
-	double minuteHandLength = 0.8 * m_radius;
-	double sinMin = std::sin(minutes + seconds/60);
-	double cosMin = std::cos(minutes + seconds/60);
-   cairo_line_to(m_cr, sinMin * minuteHandLength, -cosMin * minuteHandLength);
-   cairo_stroke(m_cr);
-
-   // draw the hours hand
-   cairo_set_source_rgba(m_cr, 0.337, 0.612, 0.117, 0.9);   // green
-   cairo_move_to(m_cr, 0, 0);
-	double hourHandLength = 0.5 * m_radius;
-	double sinHours = std::sin(hours + minutes / 12.0);
-	double cosHours = std::cos(hours + minutes / 12.0);
-   cairo_line_to(m_cr, sinHours * hourHandLength, -cosHours * hourHandLength);
-   cairo_stroke(m_cr);
-   cairo_restore(m_cr);
+   cairo_region_destroy(m_previousHands);
+   m_previousHands = 0;
+}
 
-   // draw a little dot in the middle
-   cairo_arc(m_cr, 0, 0, m_line_width / 3.0, 0, 2 * M_PI);
-   cairo_fill(m_cr);
-   cairo_stroke(m_cr);
+/**
+  Makes sure m_staticLayer holds the background, faces and ticks for this
+  size and scene. Returns true if it had to be redrawn.
+*/
+bool CairoRenderer::UpdateStaticLayer(int height, int width, const FrameContext& frame, bool opaque)
+{
+   if (m_staticLayer && (width != m_staticWidth || height != m_staticHeight || frame.clocks != m_staticClocks
+                         || opaque != m_staticOpaque))
+      InvalidateStaticLayer();
 
-   cairo_restore(m_cr);
+   if (m_staticLayer)
+      return false;
 
-   // Display FPS:
-   cairo_select_font_face(m_cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
-   cairo_set_font_size(m_cr, 11.0);
-   cairo_move_to(m_cr, 0, 10.0);
+   m_staticLayer = cairo_surface_create_similar(m_surface, opaque ? CAIRO_CONTENT_COLOR : CAIRO_CONTENT_COLOR_ALPHA,
+                                                width, height);
+   m_staticWidth = width;
+   m_staticHeight = height;
+   m_staticClocks = frame.clocks;
+   m_staticOpaque = opaque;
 
-   char message[100];
-   sprintf(message, "fps: %0.2g", fps);
-   cairo_show_text(m_cr, message);
+   cairo_t* cr = cairo_create(m_staticLayer);
 
-   cairo_surface_flush(m_surface);
+   // Painting the translucent background over the previous frame converges
+   // to the opaque colour, which is what an opaque layer starts from.
+   if (opaque)
+   {
+      cairo_set_source_rgb(cr, 0.337, 0.612, 0.117);   // green
+      cairo_paint(cr);
+   }
 
-   if (cairo_status(m_cr) != CAIRO_STATUS_SUCCESS)
-      printf("render failed with %s\n", cairo_status_to_string(cairo_status(m_cr)));
+   DrawCairoScene(cr, width, height, frame, e_StaticLayer, ScenePaints());
+   cairo_destroy(cr);
+   return true;
+}
+
+/**
+  Composites the cached static layer, rebuilding it first if the size or the
+  scene changed, and draws only the hands and the fps overlay on top.
+*/
+void CairoRenderer::RenderLayers(int height, int width, const FrameContext& frame)
+{
+   UpdateStaticLayer(height, width, frame, false);
+
+   // The layer keeps the translucency of the background, so compositing it
+   // with OVER gives exactly the pixels of drawing the static parts directly.
+   {
+      RENDER_ZONE(e_PhaseBackground);
+      cairo_save(m_cr);
+      cairo_set_source_surface(m_cr, m_staticLayer, 0, 0);
+      cairo_paint(m_cr);
+      cairo_restore(m_cr);
+   }
+
+   DrawCairoScene(m_cr, width, height, frame, e_DynamicLayer, ScenePaints(), LabelGlyphs());
+}
+
+// Generous bounds of the fps overlay drawn by DrawCairoScene.
+static const cairo_rectangle_int_t fpsLabelBounds = { 0, 0, 120, 16 };
+
+static cairo_region_t* HandRegion(int height, int width, const FrameContext& frame)
+{
+   ClockGrid grid(width, height, frame.clocks);
+
+   // Building the region from all rectangles at once is much cheaper than
+   // a union per rectangle once there are thousands of clocks.
+   std::vector<cairo_rectangle_int_t> rects;
+   rects.reserve(grid.clocks() * e_HandCount);
+
+   for (unsigned i = 0; i < grid.clocks(); ++i)
+   {
+      ClockBox bounds[e_HandCount];
+      ClockHandBounds(grid, i, frame.handsForClock(i), bounds);
+
+      for (int hand = 0; hand < e_HandCount; ++hand)
+      {
+         cairo_rectangle_int_t rect = { bounds[hand].left, bounds[hand].top, bounds[hand].width(), bounds[hand].height() };
+         rects.push_back(rect);
+      }
+   }
+
+   return cairo_region_create_rectangles(rects.empty() ? 0 : &rects[0], static_cast<int>(rects.size()));
+}
+
+/**
+  Like RenderLayers, but only repaints the damaged area: where the hands were
+  last frame, where they are now, and the fps overlay. Everything else keeps
+  the pixels of the previous frame, so the static layer is made opaque and
+  copied rather than blended.
+*/
+void CairoRenderer::RenderDamage(int height, int width, const FrameContext& frame)
+{
+   bool redrawAll = UpdateStaticLayer(height, width, frame, true);
+
+   cairo_region_t* hands = HandRegion(height, width, frame);
+
+   cairo_region_t* damage = 0;
+   if (redrawAll || !m_previousHands)
+   {
+      cairo_rectangle_int_t all = { 0, 0, width, height };
+      damage = cairo_region_create_rectangle(&all);
+   }
+   else
+   {
+      damage = cairo_region_copy(hands);
+      cairo_region_union(damage, m_previousHands);
+      cairo_region_union_rectangle(damage, &fpsLabelBounds);
+
+      cairo_rectangle_int_t all = { 0, 0, width, height };
+      cairo_region_intersect_rectangle(damage, &all);
+   }
+
+   cairo_region_destroy(m_previousHands);
+   m_previousHands = hands;
+
+   double damagedPixels = 0.0;
+   int rectangles = cairo_region_num_rectangles(damage);
+
+   cairo_save(m_cr);
+   for (int i = 0; i < rectangles; ++i)
+   {
+      cairo_rectangle_int_t rect;
+      cairo_region_get_rectangle(damage, i, &rect);
+      cairo_rectangle(m_cr, rect.x, rect.y, rect.width, rect.height);
+      damagedPixels += static_cast<double>(rect.width) * rect.height;
+   }
+   cairo_clip(m_cr);
+
+   {
+      RENDER_ZONE(e_PhaseBackground);
+      cairo_save(m_cr);
+      cairo_set_operator(m_cr, CAIRO_OPERATOR_SOURCE);
+      cairo_set_source_surface(m_cr, m_staticLayer, 0, 0);
+      cairo_paint(m_cr);
+      cairo_restore(m_cr);
+   }
+
+   DrawCairoScene(m_cr, width, height, frame, e_DynamicLayer, ScenePaints(), LabelGlyphs());
+   cairo_restore(m_cr);
+
+   cairo_region_destroy(damage);
+
+   double ratio = width && height ? damagedPixels / (static_cast<double>(width) * height) : 0.0;
+   ++m_damageFrames;
+   m_damageRatioSum += ratio;
+   if (ratio > m_damageRatioMax)
+      m_damageRatioMax = ratio;
 }
 
 void CairoRenderer::ResizeDemo(HWND hWnd, const RECT& rect)
@@ -227,9 +642,12 @@ void CairoRenderer::ResizeDemo(HWND hWnd, const RECT& rect)
 
    m_hdc = ::GetDC(hWnd);
 
-   cairo_destroy(m_cr);
    cairo_surface_destroy(m_surface);
 
    m_surface = cairo_win32_surface_create(m_hdc);
-   m_cr = cairo_create(m_surface);
+   CreateContext();
+   InvalidateStaticLayer();
+
+   cairo_surface_destroy(m_recording);
+   m_recording = 0;
 }
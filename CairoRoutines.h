@@ -28,18 +28,104 @@
 
 #include <cairo/cairo.h>
 
+class CairoCommandBuffer;
+class CairoFrameCache;
+class CairoGlyphAtlas;
+class CairoObserver;
+class CairoScriptCapture;
+struct CairoScenePaints;
+class ClockDisplayList;
+class CairoTileSet;
+class WorkerPool;
+
+/**
+  Optional rendering strategies, combined with SetRenderFlags().
+*/
+enum CairoRenderFlags
+{
+	e_CairoObserve = 1 << 0,   // route drawing through an observer surface and report per-operation costs
+	e_CairoTiles = 1 << 1,     // render tiles of the frame in parallel on a worker pool, see CairoTileSet
+	e_CairoLayers = 1 << 2,    // draw the static background, faces and ticks once into a cached layer
+	e_CairoDamage = 1 << 3,    // repaint only the pixels touched by the moving hands and the fps overlay
+	e_CairoBatch = 1 << 4,     // replay a display list through a CairoCommandBuffer that merges compatible draws
+	e_CairoPatterns = 1 << 5,  // draw with the solid patterns and line cap created in InitDemo, see CairoScenePaints
+	e_CairoGlyphAtlas = 1 << 6,// draw the fps overlay from a CairoGlyphAtlas built in InitDemo
+	e_CairoFrameCache = 1 << 7,// reuse whole frames whose hands moved less than half a pixel, see CairoFrameCache
+	e_CairoRecord = 1 << 8,    // record the static background, faces and ticks once into a recording surface and replay it
+	e_CairoRecordFrame = 1 << 9 // record every whole frame into a recording surface, then replay it
+};
+
 class CairoRenderer : public IRenderTest
 {
 public:
 	CairoRenderer(HWND hWnd, HDC hdc);
 	virtual ~CairoRenderer();
 
-	void RenderDemo(HWND hWnd, HDC hdc, int height, int width, float fps);
+	void RenderDemo(HWND hWnd, HDC hdc, int height, int width, const FrameContext& frame);
 	void ResizeDemo(HWND hWnd, const RECT& rect);
 	void InitDemo(HWND hWnd, HDC hdc);
+	void ResetStatistics();
+	void WriteStatistics(FILE* out);
+	bool SetDisplayListMode(bool enabled);
+	bool SetScriptCapture(const char* path);
+
+	// Returns false, leaving the modes unchanged, for a combination that
+	// RenderDemo cannot draw, such as two drawing paths.
+	bool SetRenderFlags(unsigned flags);
+	unsigned RenderFlags() const { return m_flags; }
+
+	// Threads used by e_CairoTiles, all logical processors by default.
+	void SetThreads(unsigned threads);
+
+	// Memory e_CairoFrameCache may use for cached frames.
+	void SetFrameCacheBudget(size_t bytes);
 
 private:
+	void CreateContext();
+	void RenderTiles(int height, int width, const FrameContext& frame);
+	void RenderLayers(int height, int width, const FrameContext& frame);
+	void RenderDamage(int height, int width, const FrameContext& frame);
+	void RenderDisplayList(int height, int width, const FrameContext& frame);
+	void RenderFrameCache(int height, int width, const FrameContext& frame);
+	void RenderRecording(int height, int width, const FrameContext& frame);
+	bool UpdateStaticLayer(int height, int width, const FrameContext& frame, bool opaque);
+	void InvalidateStaticLayer();
+	const CairoScenePaints* ScenePaints() const;
+	const CairoGlyphAtlas* LabelGlyphs() const;
+
 	cairo_surface_t* m_surface;
 	cairo_t* m_cr;
 	HDC m_hdc;
+	unsigned m_flags;
+	CairoObserver* m_observer;
+	CairoScriptCapture* m_capture;
+	unsigned m_threads;
+	WorkerPool* m_pool;
+	CairoTileSet* m_tiles;
+	cairo_surface_t* m_staticLayer;
+	int m_staticWidth;
+	int m_staticHeight;
+	unsigned m_staticClocks;
+	bool m_staticOpaque;
+
+	// e_CairoDamage: the hands drawn last frame, and the damaged share of
+	// the target per frame.
+	cairo_region_t* m_previousHands;
+	unsigned m_damageFrames;
+	double m_damageRatioSum;
+	double m_damageRatioMax;
+
+	// Set while replaying the scene from a display list.
+	ClockDisplayList* m_displayList;
+	CairoCommandBuffer* m_commandBuffer;
+	CairoScenePaints* m_paints;
+	CairoGlyphAtlas* m_labelGlyphs;
+	CairoFrameCache* m_frameCache;
+	size_t m_frameCacheBudget;
+
+	// e_CairoRecord: the static part of the scene as drawing commands.
+	cairo_surface_t* m_recording;
+	int m_recordedWidth;
+	int m_recordedHeight;
+	unsigned m_recordedClocks;
 };
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "CairoScriptTrace.h"
+
+#include "Timing.h"
+
+#include <cairo/cairo-script.h>
+
+#include <cmath>
+
+#pragma comment (lib, "cairo.lib")
+
+CairoScriptCapture::CairoScriptCapture()
+   : m_script(0), m_proxy(0), m_frames(0)
+{
+}
+
+CairoScriptCapture::~CairoScriptCapture()
+{
+   close();
+}
+
+bool CairoScriptCapture::open(const char* path)
+{
+   close();
+
+   m_script = cairo_script_create(path);
+   if (cairo_device_status(m_script) != CAIRO_STATUS_SUCCESS)
+   {
+      fprintf(stderr, "could not create the trace '%s': %s\n", path,
+              cairo_status_to_string(cairo_device_status(m_script)));
+      cairo_device_destroy(m_script);
+      m_script = 0;
+      return false;
+   }
+
+   m_frames = 0;
+   return true;
+}
+
+void CairoScriptCapture::close()
+{
+   cairo_surface_destroy(m_proxy);
+   m_proxy = 0;
+
+   if (m_script)
+   {
+      cairo_device_finish(m_script);
+      cairo_device_destroy(m_script);
+      m_script = 0;
+   }
+}
+
+cairo_surface_t* CairoScriptCapture::capture(cairo_surface_t* target)
+{
+   cairo_surface_destroy(m_proxy);
+
+   m_proxy = cairo_script_surface_create_for_target(m_script, target);
+   return m_proxy;
+}
+
+void CairoScriptCapture::endFrame(cairo_t* cr)
+{
+   // A page per frame lets the replay report a time per frame, and the
+   // comment finds a frame when reading the trace.
+   char comment[32];
+   int length = sprintf(comment, "frame %u", m_frames);
+   cairo_script_write_comment(m_script, comment, length);
+
+   cairo_show_page(cr);
+   ++m_frames;
+}
+
+#if !defined(NO_CAIRO_SCRIPT_INTERPRETER)
+
+#include <cairo/cairo-script-interpreter.h>
+
+#pragma comment (lib, "cairo-script-interpreter.lib")
+
+CairoScriptReplayResult::CairoScriptReplayResult()
+   : succeeded(false), pages(0), seconds(0.0)
+{
+}
+
+/**
+  Interpreter hooks: every surface of the trace becomes an image surface,
+  so a replay measures cairo and pixman without any window system.
+*/
+static cairo_surface_t* CreateReplaySurface(void*, cairo_content_t content, double width, double height, long)
+{
+   cairo_format_t format = CAIRO_FORMAT_ARGB32;
+   if (content == CAIRO_CONTENT_COLOR)
+      format = CAIRO_FORMAT_RGB24;
+   else if (content == CAIRO_CONTENT_ALPHA)
+      format = CAIRO_FORMAT_A8;
+
+   return cairo_image_surface_create(format, static_cast<int>(ceil(width)), static_cast<int>(ceil(height)));
+}
+
+static void CountReplayPage(void* closure, cairo_t*)
+{
+   ++*static_cast<unsigned*>(closure);
+}
+
+static bool RunCairoScript(const char* path, unsigned& pages, std::string& error)
+{
+   pages = 0;
+
+   cairo_script_interpreter_hooks_t hooks = { 0 };
+   hooks.closure = &pages;
+   hooks.surface_create = CreateReplaySurface;
+   hooks.show_page = CountReplayPage;
+
+   cairo_script_interpreter_t* csi = cairo_script_interpreter_create();
+   cairo_script_interpreter_install_hooks(csi, &hooks);
+   cairo_status_t status = cairo_script_interpreter_run(csi, path);
+   if (status == CAIRO_STATUS_SUCCESS)
+      status = cairo_script_interpreter_finish(csi);
+
+   if (status != CAIRO_STATUS_SUCCESS)
+   {
+      char line[32];
+      sprintf(line, " at line %u", cairo_script_interpreter_get_line_number(csi));
+      error = std::string(cairo_status_to_string(status)) + line;
+   }
+
+   cairo_script_interpreter_destroy(csi);
+   return status == CAIRO_STATUS_SUCCESS;
+}
+
+bool ReplayCairoScript(const char* path, int passes, CairoScriptReplayResult& result)
+{
+   result = CairoScriptReplayResult();
+
+   if (!RunCairoScript(path, result.pages, result.error))
+      return false;
+
+   unsigned pages = 0;
+   double start = MonotonicTime();
+   for (int pass = 0; pass < passes; ++pass)
+   {
+      if (!RunCairoScript(path, pages, result.error))
+         return false;
+   }
+   result.seconds = MonotonicTime() - start;
+
+   result.succeeded = true;
+   return true;
+}
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include <cairo/cairo.h>
+
+#include <cstdio>
+#include <string>
+
+/**
+  Tees drawing into a cairo-script trace file. The proxy surface returned by
+  capture() writes every operation to the trace and forwards it to the real
+  target, so the frames still appear on screen while they are recorded.
+  Each endFrame() ends a page of the trace.
+*/
+class CairoScriptCapture
+{
+public:
+   CairoScriptCapture();
+   ~CairoScriptCapture();
+
+   bool open(const char* path);
+   void close();
+   bool isOpen() const { return m_script != 0; }
+
+   /**
+     Returns a new surface that records into the trace and draws into
+     target. Any previously returned surface is released.
+   */
+   cairo_surface_t* capture(cairo_surface_t* target);
+
+   void endFrame(cairo_t* cr);
+
+   unsigned frames() const { return m_frames; }
+
+private:
+   cairo_device_t* m_script;
+   cairo_surface_t* m_proxy;
+   unsigned m_frames;
+};
+
+#if !defined(NO_CAIRO_SCRIPT_INTERPRETER)
+
+struct CairoScriptReplayResult
+{
+   CairoScriptReplayResult();
+
+   bool succeeded;
+   unsigned pages;          // show-page operations in one pass of the trace
+   double seconds;          // total over all timed passes
+   std::string error;
+};
+
+/**
+  Runs the cairo-script trace at path through the script interpreter
+  passes times (after one untimed pass to load it into the file cache),
+  drawing into image surfaces instead of the surfaces it was captured on.
+*/
+bool ReplayCairoScript(const char* path, int passes, CairoScriptReplayResult& result);
+
+#endif
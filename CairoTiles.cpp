@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "CairoTiles.h"
+
+#include "CairoClock.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#undef min
+#undef max
+
+CairoTileSet::CairoTileSet()
+   : m_width(0), m_height(0), m_data(0), m_image(0), m_frame(0)
+{
+}
+
+CairoTileSet::~CairoTileSet()
+{
+   clear();
+}
+
+void CairoTileSet::clear()
+{
+   for (size_t i = 0; i < m_tiles.size(); ++i)
+   {
+      cairo_destroy(m_tiles[i].cr);
+      cairo_surface_destroy(m_tiles[i].surface);
+   }
+   m_tiles.clear();
+
+   cairo_surface_destroy(m_image);
+   m_image = 0;
+
+   free(m_data);
+   m_data = 0;
+
+   m_width = 0;
+   m_height = 0;
+}
+
+void CairoTileSet::resize(int width, int height)
+{
+   if (width == m_width && height == m_height)
+      return;
+
+   clear();
+
+   const int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+   m_data = static_cast<unsigned char*>(calloc(height, stride));
+   if (!m_data)
+      return;
+
+   m_width = width;
+   m_height = height;
+   m_image = cairo_image_surface_create_for_data(m_data, CAIRO_FORMAT_ARGB32, width, height, stride);
+
+   for (int y = 0; y < height; y += tileSize)
+   {
+      for (int x = 0; x < width; x += tileSize)
+      {
+         Tile tile;
+         tile.x = x;
+         tile.y = y;
+         tile.surface = cairo_image_surface_create_for_data(m_data + y * stride + x * 4, CAIRO_FORMAT_ARGB32,
+                                                            std::min(tileSize, width - x), std::min(tileSize, height - y),
+                                                            stride);
+         tile.cr = cairo_create(tile.surface);
+         m_tiles.push_back(tile);
+      }
+   }
+}
+
+void CairoTileSet::render(WorkerPool& pool, int width, int height, const FrameContext& frame)
+{
+   resize(width, height);
+   if (!m_image)
+      return;
+
+   m_frame = &frame;
+   pool.run(renderTile, this, tiles());
+   m_frame = 0;
+
+   cairo_surface_mark_dirty(m_image);
+}
+
+void CairoTileSet::renderTile(void* context, unsigned index)
+{
+   CairoTileSet* tileSet = static_cast<CairoTileSet*>(context);
+   Tile& tile = tileSet->m_tiles[index];
+
+   // Draw the whole scene shifted so that this tile's pixels land on the
+   // tile surface; DrawCairoClocks skips the clocks outside of it.
+   cairo_identity_matrix(tile.cr);
+   cairo_translate(tile.cr, -tile.x, -tile.y);
+   DrawCairoScene(tile.cr, tileSet->m_width, tileSet->m_height, *tileSet->m_frame);
+   cairo_surface_flush(tile.surface);
+}
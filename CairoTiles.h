@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include "FrameContext.h"
+
+#include <cairo/cairo.h>
+
+#include <vector>
+
+class WorkerPool;
+
+/**
+  Renders a frame as a set of square tiles on a WorkerPool.
+
+  All tiles share one ARGB32 buffer. Every tile is its own image surface
+  over its part of that buffer (cairo_image_surface_create_for_data with
+  the full-frame stride) with its own cairo_t, so no cairo object is ever
+  touched by two threads at once. Sub-surfaces of one shared surface
+  (cairo_surface_create_for_rectangle) would be simpler, but they all write
+  through the same parent cairo_surface_t, which is not safe to use from
+  several threads.
+*/
+class CairoTileSet
+{
+public:
+   CairoTileSet();
+   ~CairoTileSet();
+
+   /**
+     Draws the scene of frame into the shared buffer, reallocating the tiles
+     if the size changed.
+   */
+   void render(WorkerPool& pool, int width, int height, const FrameContext& frame);
+
+   // The whole frame, valid after render().
+   cairo_surface_t* image() const { return m_image; }
+
+   unsigned tiles() const { return static_cast<unsigned>(m_tiles.size()); }
+
+   static const int tileSize = 128;
+
+private:
+   struct Tile
+   {
+      int x;
+      int y;
+      cairo_surface_t* surface;
+      cairo_t* cr;
+   };
+
+   static void renderTile(void* context, unsigned index);
+
+   void resize(int width, int height);
+   void clear();
+
+   int m_width;
+   int m_height;
+   unsigned char* m_data;
+   cairo_surface_t* m_image;
+   std::vector<Tile> m_tiles;
+   const FrameContext* m_frame;
+};
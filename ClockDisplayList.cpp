@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "ClockDisplayList.h"
+
+#include "ClockGeometry.h"
+#include "ClockGrid.h"
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+ClockDisplayList::ClockDisplayList()
+   : m_width(0), m_height(0), m_clocks(0), m_textCommand(0), m_lineWidth(0)
+{
+}
+
+bool ClockDisplayList::matches(int width, int height, unsigned clocks) const
+{
+   return !m_commands.empty() && width == m_width && height == m_height && clocks == m_clocks;
+}
+
+void ClockDisplayList::append(DisplayOp op, float a0, float a1, float a2, float a3, float a4, float a5)
+{
+   DisplayCommand command;
+   command.op = op;
+   command.args[0] = a0;
+   command.args[1] = a1;
+   command.args[2] = a2;
+   command.args[3] = a3;
+   command.args[4] = a4;
+   command.args[5] = a5;
+   m_commands.push_back(command);
+}
+
+void ClockDisplayList::setColor(float r, float g, float b, float a)
+{
+   if (r == m_color[0] && g == m_color[1] && b == m_color[2] && a == m_color[3])
+      return;
+
+   m_color[0] = r;
+   m_color[1] = g;
+   m_color[2] = b;
+   m_color[3] = a;
+   append(e_DisplaySetColor, r, g, b, a);
+}
+
+void ClockDisplayList::setLineWidth(float width)
+{
+   if (width == m_lineWidth)
+      return;
+
+   m_lineWidth = width;
+   append(e_DisplaySetLineWidth, width);
+}
+
+void ClockDisplayList::build(int width, int height, unsigned clocks)
+{
+   ClockGrid grid(width, height, clocks);
+
+   m_width = width;
+   m_height = height;
+   m_clocks = grid.clocks();
+   m_commands.clear();
+   m_handCommands.clear();
+
+   // Players start from an unknown state, so the first change of each kind
+   // is always recorded.
+   m_color[0] = m_color[1] = m_color[2] = m_color[3] = -1.0f;
+   m_lineWidth = -1.0f;
+
+   const float radius = static_cast<float>(clockRadius);
+   const float lineWidth = static_cast<float>(clockLineWidth);
+
+   append(e_DisplaySetTransform, 1, 0, 0, 1, 0, 0);
+   setColor(0.337f, 0.612f, 0.117f, 0.9f);   // green
+   append(e_DisplayFillRect, 0, 0, static_cast<float>(width), static_cast<float>(height));
+
+   for (unsigned i = 0; i < grid.clocks(); ++i)
+   {
+      // Map the unit square onto the cell, centred on the origin.
+      append(e_DisplaySetTransform,
+             static_cast<float>(grid.cellWidth()), 0, 0, static_cast<float>(grid.cellHeight()),
+             static_cast<float>(grid.cellX(i) + 0.5 * grid.cellWidth()),
+             static_cast<float>(grid.cellY(i) + 0.5 * grid.cellHeight()));
+
+      // Clock face
+      setColor(1.0f, 1.0f, 1.0f, 0.8f);
+      append(e_DisplayFillCircle, 0, 0, radius);
+      setColor(0.0f, 0.0f, 0.0f, 1.0f);
+      setLineWidth(lineWidth);
+      append(e_DisplayStrokeCircle, 0, 0, radius);
+
+      // clock ticks: the ticks never overlap, so the four major ones are
+      // recorded before the minor ones to need one width change, not eight.
+      for (int n = 0; n < 12; ++n)
+      {
+         const int tick = n < 4 ? n * 3 : (n - 4) + (n - 4) / 2 + 1;
+         float inset = 0.05f;
+         setLineWidth(lineWidth);
+
+         if (tick % 3 != 0)
+         {
+            inset *= 0.8f;
+            setLineWidth(0.03f);
+         }
+
+         const float angle = static_cast<float>(tick * M_PI / 6.0);
+         const float sinAngle = sinf(angle);
+         const float cosAngle = cosf(angle);
+
+         append(e_DisplayStrokeLine, (radius - inset) * cosAngle, (radius - inset) * sinAngle,
+                radius * cosAngle, radius * sinAngle);
+      }
+
+      // The hands start at the centre; update() fills in their tips.
+      setColor(0.7f, 0.7f, 0.7f, 0.8f); // gray
+      setLineWidth(static_cast<float>(secondHandWidth));
+      m_handCommands.push_back(m_commands.size());
+      append(e_DisplayStrokeLine);
+
+      setColor(0.117f, 0.337f, 0.612f, 0.9f);   // blue
+      setLineWidth(lineWidth);
+      m_handCommands.push_back(m_commands.size());
+      append(e_DisplayStrokeLine);
+
+      setColor(0.337f, 0.612f, 0.117f, 0.9f);   // green
+      m_handCommands.push_back(m_commands.size());
+      append(e_DisplayStrokeLine);
+
+      // a little dot in the middle
+      setColor(0.0f, 0.0f, 0.0f, 1.0f);
+      append(e_DisplayFillCircle, 0, 0, lineWidth / 3.0f);
+   }
+
+   append(e_DisplaySetTransform, 1, 0, 0, 1, 0, 0);
+   m_textCommand = m_commands.size();
+   append(e_DisplayText, 0, 10.0f, 0);
+}
+
+void ClockDisplayList::update(const FrameContext& frame)
+{
+   static const double lengths[e_HandCount] = { secondHandLength, minuteHandLength, hourHandLength };
+
+   for (unsigned i = 0; i < m_clocks; ++i)
+   {
+      ClockHands hands = frame.handsForClock(i);
+      const double angles[e_HandCount] = { hands.seconds, hands.minutes, hands.hours };
+
+      for (int hand = 0; hand < e_HandCount; ++hand)
+      {
+         DisplayCommand& command = m_commands[m_handCommands[i * e_HandCount + hand]];
+         command.args[2] = static_cast<float>(std::sin(angles[hand]) * lengths[hand]);
+         command.args[3] = static_cast<float>(-std::cos(angles[hand]) * lengths[hand]);
+      }
+   }
+
+   m_commands[m_textCommand].args[2] = frame.fps;
+}
+
+void ClockDisplayList::play(DisplayListPlayer& player) const
+{
+   for (size_t i = 0; i < m_commands.size(); ++i)
+   {
+      const DisplayCommand& command = m_commands[i];
+      const float* args = command.args;
+
+      switch (command.op)
+      {
+      case e_DisplaySetTransform:
+         player.setTransform(args);
+         break;
+      case e_DisplaySetColor:
+         player.setColor(args[0], args[1], args[2], args[3]);
+         break;
+      case e_DisplaySetLineWidth:
+         player.setLineWidth(args[0]);
+         break;
+      case e_DisplayFillRect:
+         player.fillRect(args[0], args[1], args[2], args[3]);
+         break;
+      case e_DisplayFillCircle:
+         player.fillCircle(args[0], args[1], args[2]);
+         break;
+      case e_DisplayStrokeCircle:
+         player.strokeCircle(args[0], args[1], args[2]);
+         break;
+      case e_DisplayStrokeLine:
+         player.strokeLine(args[0], args[1], args[2], args[3]);
+         break;
+      case e_DisplayText:
+         player.text(args[0], args[1], args[2]);
+         break;
+      }
+   }
+}
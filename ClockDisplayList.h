@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include "FrameContext.h"
+
+#include <vector>
+
+enum DisplayOp
+{
+   e_DisplaySetTransform,     // xx, yx, xy, yy, x0, y0 (as cairo_matrix_t)
+   e_DisplaySetColor,         // r, g, b, a
+   e_DisplaySetLineWidth,     // width
+   e_DisplayFillRect,         // x, y, width, height
+   e_DisplayFillCircle,       // cx, cy, radius
+   e_DisplayStrokeCircle,     // cx, cy, radius
+   e_DisplayStrokeLine,       // x0, y0, x1, y1, with round caps
+   e_DisplayText              // x, y, fps (the overlay label)
+};
+
+struct DisplayCommand
+{
+   DisplayOp op;
+   float args[6];
+};
+
+/**
+  Receives the commands of a ClockDisplayList. Each backend implements one;
+  the current transform, colour and line width persist until changed.
+*/
+class DisplayListPlayer
+{
+public:
+   virtual ~DisplayListPlayer() {}
+
+   virtual void setTransform(const float matrix[6]) = 0;
+   virtual void setColor(float r, float g, float b, float a) = 0;
+   virtual void setLineWidth(float width) = 0;
+   virtual void fillRect(float x, float y, float width, float height) = 0;
+   virtual void fillCircle(float cx, float cy, float radius) = 0;
+   virtual void strokeCircle(float cx, float cy, float radius) = 0;
+   virtual void strokeLine(float x0, float y0, float x1, float y1) = 0;
+   virtual void text(float x, float y, float fps) = 0;
+};
+
+/**
+  The whole clock scene as a flat, retained list of drawing commands.
+
+  build() records the scene once for a size and clock count, dropping state
+  changes that would not change anything. Only the end points of the hands
+  and the fps value depend on the time, so update() patches just those
+  commands in place each frame before play() replays the list.
+*/
+class ClockDisplayList
+{
+public:
+   ClockDisplayList();
+
+   bool matches(int width, int height, unsigned clocks) const;
+   void build(int width, int height, unsigned clocks);
+
+   void update(const FrameContext& frame);
+   void play(DisplayListPlayer&) const;
+
+   size_t size() const { return m_commands.size(); }
+
+private:
+   void append(DisplayOp, float a0 = 0, float a1 = 0, float a2 = 0, float a3 = 0, float a4 = 0, float a5 = 0);
+   void setColor(float r, float g, float b, float a);
+   void setLineWidth(float width);
+
+   int m_width;
+   int m_height;
+   unsigned m_clocks;
+
+   std::vector<DisplayCommand> m_commands;
+
+   // Indices of the commands patched by update(): three hands per clock.
+   std::vector<size_t> m_handCommands;
+   size_t m_textCommand;
+
+   // State while recording.
+   float m_color[4];
+   float m_lineWidth;
+};
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "ClockGeometry.h"
+
+#include "ClockGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#undef min
+#undef max
+
+// Not M_PI: <algorithm> may already have pulled in math.h without it.
+static const double pi = 3.14159265358979323846;
+
+static ClockBox HandBox(const ClockGrid& grid, unsigned index, double angle, double length, double width)
+{
+   const double centreX = grid.cellX(index) + 0.5 * grid.cellWidth();
+   const double centreY = grid.cellY(index) + 0.5 * grid.cellHeight();
+
+   const double tipX = centreX + std::sin(angle) * length * grid.cellWidth();
+   const double tipY = centreY - std::cos(angle) * length * grid.cellHeight();
+
+   // Round caps reach half the line width past both ends, in each direction.
+   const double capX = 0.5 * width * grid.cellWidth() + 1.0;
+   const double capY = 0.5 * width * grid.cellHeight() + 1.0;
+
+   ClockBox box;
+   box.left = static_cast<int>(std::floor(std::min(centreX, tipX) - capX));
+   box.top = static_cast<int>(std::floor(std::min(centreY, tipY) - capY));
+   box.right = static_cast<int>(std::ceil(std::max(centreX, tipX) + capX));
+   box.bottom = static_cast<int>(std::ceil(std::max(centreY, tipY) + capY));
+   return box;
+}
+
+void ClockHandBounds(const ClockGrid& grid, unsigned index, const ClockHands& hands, ClockBox bounds[e_HandCount])
+{
+   bounds[e_SecondHand] = HandBox(grid, index, hands.seconds, secondHandLength, secondHandWidth);
+   bounds[e_MinuteHand] = HandBox(grid, index, hands.minutes, minuteHandLength, clockLineWidth);
+   bounds[e_HourHand] = HandBox(grid, index, hands.hours, hourHandLength, clockLineWidth);
+}
+
+double SecondsUntilHandsMove(const ClockGrid& grid, const FrameContext& frame, double pixels)
+{
+   // A clock is stretched to its cell, so a tip moves at most this fast.
+   const double cellSize = std::max(grid.cellWidth(), grid.cellHeight());
+   if (cellSize <= 0.0)
+      return HUGE_VAL;
+
+   const double secondHandSpeed = secondHandLength * cellSize * 2 * pi / 60.0;        // pixels per second
+   const double minuteHandSpeed = minuteHandLength * cellSize * 2 * pi / 3600.0;
+   double seconds = std::min(pixels / secondHandSpeed, pixels / minuteHandSpeed);
+
+   // The hour hand needs this many of its one minute steps to move far enough.
+   const double hourStep = hourHandLength * cellSize * 2 * pi / 720.0;
+   const double steps = std::ceil(pixels / hourStep);
+   if ((steps - 1) * 60.0 >= seconds)
+      return seconds;
+
+   for (unsigned i = 0; i < grid.clocks(); ++i)
+   {
+      // The seconds hand tells where in its minute each clock is.
+      const double intoMinute = frame.handsForClock(i).seconds * 30.0 / pi;
+      seconds = std::min(seconds, 60.0 - intoMinute + (steps - 1) * 60.0);
+   }
+
+   return seconds;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include "FrameContext.h"
+
+class ClockGrid;
+
+// Dimensions of a clock in its unit cell, as drawn by every renderer.
+static const double clockRadius = 0.42;
+static const double clockLineWidth = 0.05;
+static const double secondHandLength = 0.9 * clockRadius;
+static const double minuteHandLength = 0.8 * clockRadius;
+static const double hourHandLength = 0.5 * clockRadius;
+static const double secondHandWidth = clockLineWidth / 3;
+
+enum ClockHand
+{
+   e_SecondHand,
+   e_MinuteHand,
+   e_HourHand,
+   e_HandCount
+};
+
+/**
+  An axis-aligned box in target pixels, with integer edges.
+*/
+struct ClockBox
+{
+   int left;
+   int top;
+   int right;
+   int bottom;
+
+   int width() const { return right - left; }
+   int height() const { return bottom - top; }
+};
+
+/**
+  Pixel bounds of each hand of clock index of grid: the stroke from the
+  centre with its round caps (which also covers the centre dot), plus a
+  pixel for antialiasing.
+*/
+void ClockHandBounds(const ClockGrid& grid, unsigned index, const ClockHands& hands, ClockBox bounds[e_HandCount]);
+
+/**
+  Seconds of clock time from frame until the tip of some hand of the grid
+  has moved by at least pixels: the seconds and minute hands turn smoothly,
+  while the hour hand steps once a minute, at a different second for each
+  clock of a multi-clock scene.
+*/
+double SecondsUntilHandsMove(const ClockGrid& grid, const FrameContext& frame, double pixels);
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+/**
+  Shapes drawn for each clock: the face, its rim, twelve ticks, three hands
+  and the centre dot.
+*/
+static const unsigned primitivesPerClock = 18;
+
+/**
+  Lays a number of clocks out in a near-square grid of equal cells covering
+  a width x height target. A single clock gets the whole target, as the
+  original demo did.
+*/
+class ClockGrid
+{
+public:
+   ClockGrid(int width, int height, unsigned clocks);
+
+   unsigned clocks() const { return m_clocks; }
+   unsigned columns() const { return m_columns; }
+   unsigned rows() const { return m_rows; }
+
+   double cellWidth() const { return m_cellWidth; }
+   double cellHeight() const { return m_cellHeight; }
+
+   // Top left corner of the cell of clock index, in pixels.
+   double cellX(unsigned index) const { return (index % m_columns) * m_cellWidth; }
+   double cellY(unsigned index) const { return (index / m_columns) * m_cellHeight; }
+
+private:
+   unsigned m_clocks;
+   unsigned m_columns;
+   unsigned m_rows;
+   double m_cellWidth;
+   double m_cellHeight;
+};
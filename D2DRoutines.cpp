@@ -27,6 +27,10 @@
 
 #include "D2DRoutines.h"
 
+#include "ClockDisplayList.h"
+#include "ClockGrid.h"
+#include "RenderZones.h"
+
 #include <d2d1.h>
 #include <d2d1helper.h>
 
@@ -40,7 +44,8 @@
 
 D2DRenderer::D2DRenderer (HWND hWnd, HDC hdc) : m_pDirect2dFactory(0), m_pRenderTarget(0),
 	m_pGreenBrush(0), m_pWhiteBrush(0), m_pBlackBrush(0), m_pGreyBrush(0),
-	m_pBlueBrush(0), m_pRoundCapStyle(0), m_pDirectWriteFactory(0), m_pTextFormat(0)
+	m_pBlueBrush(0), m_pRoundCapStyle(0), m_pDirectWriteFactory(0), m_pTextFormat(0),
+	m_pListBrush(0), m_displayList(0)
 {
    InitDemo (hWnd, hdc);
 }
@@ -66,6 +71,8 @@ D2DRenderer::~D2DRenderer ()
    SafeRelease(&m_pBlueBrush);
    SafeRelease(&m_pRoundCapStyle);
    SafeRelease(&m_pTextFormat);
+   SafeRelease(&m_pListBrush);
+   delete m_displayList;
 }
 
 void D2DRenderer::InitDemo (HWND hWnd, HDC hdc)
@@ -109,6 +116,10 @@ void D2DRenderer::InitDemo (HWND hWnd, HDC hdc)
    if (!SUCCEEDED(hr))
       return;
 
+   hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(0.0f, 0.0f, 0.0f, 1.0f), &m_pListBrush);
+   if (!SUCCEEDED(hr))
+      return;
+
    hr = m_pDirect2dFactory->CreateStrokeStyle (D2D1::StrokeStyleProperties(D2D1_CAP_STYLE_ROUND, D2D1_CAP_STYLE_ROUND, D2D1_CAP_STYLE_ROUND), 0, 0, &m_pRoundCapStyle);
    if (!SUCCEEDED(hr))
       return;
@@ -117,108 +128,216 @@ void D2DRenderer::InitDemo (HWND hWnd, HDC hdc)
                                                 DWRITE_FONT_STRETCH_NORMAL, 11.0, L"", &m_pTextFormat);
 }
 
-void D2DRenderer::RenderDemo (HWND hWnd, HDC hdc, int height, int width, float fps)
+/**
+  Replays a ClockDisplayList into a render target between BeginDraw and
+  EndDraw.
+*/
+class D2DDisplayListPlayer : public DisplayListPlayer
 {
-   _ASSERT (m_pRenderTarget);
-   if (!m_pRenderTarget)
-      return;
+public:
+   D2DDisplayListPlayer(ID2D1RenderTarget* target, ID2D1SolidColorBrush* brush, ID2D1StrokeStyle* roundCapStyle,
+                        IDWriteTextFormat* textFormat)
+      : m_target(target), m_brush(brush), m_roundCapStyle(roundCapStyle), m_textFormat(textFormat), m_lineWidth(1.0f)
+   {
+   }
 
-   HRESULT hr = S_OK;
+   void setTransform(const float matrix[6])
+   {
+      m_target->SetTransform(D2D1::Matrix3x2F(matrix[0], matrix[1], matrix[2], matrix[3], matrix[4], matrix[5]));
+   }
 
-   m_pRenderTarget->BeginDraw();
+   void setColor(float r, float g, float b, float a)
+   {
+      m_brush->SetColor(D2D1::ColorF(r, g, b, a));
+   }
 
-   // Reset to identity
-   m_pRenderTarget->SetTransform(D2D1::Matrix3x2F::Identity());
+   void setLineWidth(float width)
+   {
+      m_lineWidth = width;
+   }
 
-   float m_radius = 0.42f;
-   float m_line_width = 0.05f;
+   void fillRect(float x, float y, float width, float height)
+   {
+      m_target->FillRectangle(D2D1::RectF(x, y, x + width, y + height), m_brush);
+   }
 
-   const D2D1::Matrix3x2F scale = D2D1::Matrix3x2F::Scale(width, height);
+   void fillCircle(float cx, float cy, float radius)
+   {
+      m_target->FillEllipse(D2D1::Ellipse(D2D1::Point2F(cx, cy), radius, radius), m_brush);
+   }
 
-   m_pRenderTarget->SetTransform(scale);
+   void strokeCircle(float cx, float cy, float radius)
+   {
+      m_target->DrawEllipse(D2D1::Ellipse(D2D1::Point2F(cx, cy), radius, radius), m_brush, m_lineWidth);
+   }
 
-   D2D1::Matrix3x2F curr;
-   m_pRenderTarget->GetTransform (&curr);
+   void strokeLine(float x0, float y0, float x1, float y1)
+   {
+      m_target->DrawLine(D2D1::Point2F(x0, y0), D2D1::Point2F(x1, y1), m_brush, m_lineWidth, m_roundCapStyle);
+   }
 
-   const D2D1::Matrix3x2F trans = D2D1::Matrix3x2F::Translation(0.5f * width, 0.5f * height);
-   m_pRenderTarget->SetTransform(curr * trans);
+   void text(float x, float y, float fps)
+   {
+      // The list stores the baseline; DirectWrite lays out from the top.
+      D2D1_SIZE_F size = m_target->GetSize();
+      wchar_t message[100];
+      int length = swprintf(message, 100, L"fps: %0.2g", fps);
+      m_target->DrawText(message, length, m_textFormat, D2D1::RectF(x, y - 10.0f, size.width, size.height), m_brush);
+   }
 
-   D2D1_RECT_F rect = D2D1::RectF(-0.5f, -0.5f, 0.5f, 0.5f);
-   m_pRenderTarget->FillRectangle(rect, m_pGreenBrush);
+private:
+   ID2D1RenderTarget* m_target;
+   ID2D1SolidColorBrush* m_brush;
+   ID2D1StrokeStyle* m_roundCapStyle;
+   IDWriteTextFormat* m_textFormat;
+   float m_lineWidth;
+};
+
+bool D2DRenderer::SetDisplayListMode(bool enabled)
+{
+   delete m_displayList;
+   m_displayList = enabled ? new ClockDisplayList : 0;
+   return true;
+}
+
+/**
+  Draws one clock centred on the origin of the current transform, which maps
+  a unit square onto the clock's cell.
+*/
+void D2DRenderer::DrawClock (const ClockHands& hands)
+{
+   float m_radius = 0.42f;
+   float m_line_width = 0.05f;
 
    D2D1_ELLIPSE ellipse = D2D1::Ellipse(D2D1::Point2F(0.0f, 0.0f), m_radius, m_radius);
-   m_pRenderTarget->FillEllipse(ellipse, m_pWhiteBrush);
-   m_pRenderTarget->DrawEllipse(ellipse, m_pBlackBrush, m_line_width);
 
-   //clock ticks
-   for (int i = 0; i < 12; ++i)
    {
-      float inset = 0.05f;
-      float strokeWidth = m_line_width;
+      RENDER_ZONE(e_PhaseFace);
+      m_pRenderTarget->FillEllipse(ellipse, m_pWhiteBrush);
+      m_pRenderTarget->DrawEllipse(ellipse, m_pBlackBrush, m_line_width);
+   }
 
-      if (i % 3 != 0)
+   //clock ticks
+   {
+      RENDER_ZONE(e_PhaseTicks);
+      for (int i = 0; i < 12; ++i)
       {
-         inset *= 0.8f;
-         strokeWidth = 0.03f;
+         float inset = 0.05f;
+         float strokeWidth = m_line_width;
+
+         if (i % 3 != 0)
+         {
+            inset *= 0.8f;
+            strokeWidth = 0.03f;
+         }
+
+         const float angle = static_cast<float>(i * M_PI / 6.0);
+         const float sinAngle = sinf(angle);
+         const float cosAngle = cosf(angle);
+
+         D2D_POINT_2F startPoint = D2D1::Point2F((m_radius - inset) * cosAngle, (m_radius - inset) * sinAngle);
+         D2D_POINT_2F endPoint = D2D1::Point2F(m_radius * cosAngle, m_radius * sinAngle);
+
+         m_pRenderTarget->DrawLine (startPoint, endPoint, m_pBlackBrush, strokeWidth, m_pRoundCapStyle);
       }
+   }
+
+   {
+      RENDER_ZONE(e_PhaseHands);
 
-      const float angle = static_cast<float>(i * M_PI / 6.0);
-      const float sinAngle = sinf(angle);
-      const float cosAngle = cosf(angle);
+      // draw the seconds hand
+      float secondHandLength = 0.9f * m_radius;
+      float sinSec = sinf(hands.seconds);
+      float cosSec = -cosf(hands.seconds);
+      D2D_POINT_2F endSecondsPoint = D2D1::Point2F (sinSec * secondHandLength, cosSec * secondHandLength);
 
-      D2D_POINT_2F startPoint = D2D1::Point2F((m_radius - inset) * cosAngle, (m_radius - inset) * sinAngle);
-      D2D_POINT_2F endPoint = D2D1::Point2F(m_radius * cosAngle, m_radius * sinAngle);
+      m_pRenderTarget->DrawLine (ellipse.point, endSecondsPoint, m_pGreyBrush, m_line_width / 3, m_pRoundCapStyle);
 
-      m_pRenderTarget->DrawLine (startPoint, endPoint, m_pBlackBrush, strokeWidth, m_pRoundCapStyle);
+      // draw the minutes hand
+      float minuteHandLength = 0.8f * m_radius;
+      float sinMin = sinf(hands.minutes);
+      float cosMin = -cosf(hands.minutes);
+      D2D_POINT_2F endMinutesPoint = D2D1::Point2F (sinMin * minuteHandLength, cosMin * minuteHandLength);
+
+      m_pRenderTarget->DrawLine (ellipse.point, endMinutesPoint, m_pBlueBrush, m_line_width, m_pRoundCapStyle);
+
+      // draw the hours hand
+      float hourHandLength = 0.5f * m_radius;
+      float sinHours = sinf(hands.hours);
+      float cosHours = -cosf(hands.hours);
+      D2D_POINT_2F endHoursPoint = D2D1::Point2F (sinHours * hourHandLength, cosHours * hourHandLength);
+
+      m_pRenderTarget->DrawLine (ellipse.point, endHoursPoint, m_pGreenBrush, m_line_width, m_pRoundCapStyle);
+
+      // draw a little dot in the middle
+      D2D1_ELLIPSE dot = D2D1::Ellipse(D2D1::Point2F(0.0f, 0.0f), m_line_width / 3.0f, m_line_width / 3.0f);
+      m_pRenderTarget->FillEllipse(dot, m_pBlackBrush);
    }
+}
+
+void D2DRenderer::RenderDemo (HWND hWnd, HDC hdc, int height, int width, const FrameContext& frame)
+{
+   _ASSERT (m_pRenderTarget);
+   if (!m_pRenderTarget)
+      return;
 
-   // store the current time
-   SYSTEMTIME time;
-   GetLocalTime(&time);
+   HRESULT hr = S_OK;
 
-   // compute the angles of the indicators of our clock
-   double minutes = time.wMinute * M_PI / 30;
-   double hours = time.wHour * M_PI / 6;
-   double seconds= ((double)time.wSecond + (double)time.wMilliseconds / 1000) * M_PI / 30;
+   m_pRenderTarget->BeginDraw();
 
-   // draw the seconds hand
-   float secondHandLength = 0.9f * m_radius;
-   float sinSec = sinf(seconds);
-   float cosSec = -cosf(seconds);
-   D2D_POINT_2F endSecondsPoint = D2D1::Point2F (sinSec * secondHandLength, cosSec * secondHandLength);
+   if (m_displayList)
+   {
+      if (!m_displayList->matches(width, height, frame.clocks))
+         m_displayList->build(width, height, frame.clocks);
 
-   m_pRenderTarget->DrawLine (ellipse.point, endSecondsPoint, m_pGreyBrush, m_line_width / 3, m_pRoundCapStyle);
+      m_displayList->update(frame);
 
-   // draw the minutes hand
-   float minuteHandLength = 0.8f * m_radius;
-   float sinMin = sinf(minutes + seconds/60);
-   float cosMin = -cosf(minutes + seconds/60);
-   D2D_POINT_2F endMinutesPoint = D2D1::Point2F (sinMin * minuteHandLength, cosMin * minuteHandLength);
+      D2DDisplayListPlayer player(m_pRenderTarget, m_pListBrush, m_pRoundCapStyle, m_pTextFormat);
+      m_displayList->play(player);
 
-   m_pRenderTarget->DrawLine (ellipse.point, endMinutesPoint, m_pBlueBrush, m_line_width, m_pRoundCapStyle);
+      RENDER_ZONE(e_PhaseFlush);
+      hr = m_pRenderTarget->EndDraw();
+      return;
+   }
 
-   // draw the hours hand
-   float hourHandLength = 0.5f * m_radius;
-   float sinHours = sinf(hours + minutes / 12.0f);
-   float cosHours = -cosf(hours + minutes / 12.0f);
-   D2D_POINT_2F endHoursPoint = D2D1::Point2F (sinHours * hourHandLength, cosHours * hourHandLength);
+   // Reset to identity
+   m_pRenderTarget->SetTransform(D2D1::Matrix3x2F::Identity());
 
-   m_pRenderTarget->DrawLine (ellipse.point, endHoursPoint, m_pGreenBrush, m_line_width, m_pRoundCapStyle);
+   {
+      RENDER_ZONE(e_PhaseBackground);
+      D2D1_RECT_F rect = D2D1::RectF(0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height));
+      m_pRenderTarget->FillRectangle(rect, m_pGreenBrush);
+   }
 
-   // draw a little dot in the middle
-   D2D1_ELLIPSE dot = D2D1::Ellipse(D2D1::Point2F(0.0f, 0.0f), m_line_width / 3.0f, m_line_width / 3.0f);
-   m_pRenderTarget->FillEllipse(dot, m_pBlackBrush);
+   ClockGrid grid(width, height, frame.clocks);
+   for (unsigned i = 0; i < grid.clocks(); ++i)
+   {
+      const D2D1::Matrix3x2F scale = D2D1::Matrix3x2F::Scale(static_cast<float>(grid.cellWidth()), static_cast<float>(grid.cellHeight()));
+      const D2D1::Matrix3x2F trans = D2D1::Matrix3x2F::Translation(static_cast<float>(grid.cellX(i) + 0.5 * grid.cellWidth()),
+                                                                   static_cast<float>(grid.cellY(i) + 0.5 * grid.cellHeight()));
+      m_pRenderTarget->SetTransform(scale * trans);
+
+      DrawClock(frame.handsForClock(i));
+   }
 
    // Display FPS:
-   m_pRenderTarget->SetTransform(D2D1::Matrix3x2F::Identity());
-   D2D1_SIZE_F renderTargetSize = m_pRenderTarget->GetSize();
-   wchar_t message[100];
-   int length = swprintf(message, 100, L"fps: %0.2g", fps);
-   m_pRenderTarget->DrawText(message, length, m_pTextFormat,
-                             D2D1::RectF(0, 0, renderTargetSize.width, renderTargetSize.height),
-                             m_pBlackBrush);
-
-   hr = m_pRenderTarget->EndDraw();
+   {
+      RENDER_ZONE(e_PhaseText);
+      m_pRenderTarget->SetTransform(D2D1::Matrix3x2F::Identity());
+      D2D1_SIZE_F renderTargetSize = m_pRenderTarget->GetSize();
+      wchar_t message[100];
+      int length = swprintf(message, 100, L"fps: %0.2g", frame.fps);
+      m_pRenderTarget->DrawText(message, length, m_pTextFormat,
+                                D2D1::RectF(0, 0, renderTargetSize.width, renderTargetSize.height),
+                                m_pBlackBrush);
+   }
+
+   {
+      // Direct2D batches everything until EndDraw, so this is where the
+      // rasterization cost of the whole frame shows up.
+      RENDER_ZONE(e_PhaseFlush);
+      hr = m_pRenderTarget->EndDraw();
+   }
 
    //if (hr != D2DERR_RECREATE_TARGET)
    //   printf("render failed with %s\n", cairo_status_to_string(cairo_status(g_cr)));
@@ -30,17 +30,22 @@
 #include <d2d1helper.h>
 #include <dwrite.h>
 
+class ClockDisplayList;
+
 class D2DRenderer : public IRenderTest
 {
 public:
 	D2DRenderer(HWND hWnd, HDC hdc);
 	virtual ~D2DRenderer();
 
-	void RenderDemo(HWND hWnd, HDC hdc, int height, int width, float fps);
+	void RenderDemo(HWND hWnd, HDC hdc, int height, int width, const FrameContext& frame);
 	void ResizeDemo(HWND hWnd, const RECT& rect);
 	void InitDemo(HWND hWnd, HDC hdc);
+	bool SetDisplayListMode(bool enabled);
 
 private:
+	void DrawClock(const ClockHands& hands);
+
 	ID2D1Factory*           m_pDirect2dFactory;
    IDWriteFactory*         m_pDirectWriteFactory;
 
@@ -52,4 +57,8 @@ private:
 	ID2D1SolidColorBrush*   m_pBlueBrush;
 	ID2D1StrokeStyle*       m_pRoundCapStyle;
    IDWriteTextFormat*      m_pTextFormat;
+
+	// Display list mode replays with one brush whose colour is changed.
+	ID2D1SolidColorBrush*   m_pListBrush;
+	ClockDisplayList*       m_displayList;
 };
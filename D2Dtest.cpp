@@ -26,13 +26,25 @@
 #include "stdafx.h"
 #include "D2Dtest.h"
 
+#include "BenchmarkRunner.h"
 #include "CairoRoutines.h"
 #include "CairoGLRoutines.h"
 #include "CGRoutines.h"
+#include "ClockGeometry.h"
+#include "ClockGrid.h"
 #include "D2DRoutines.h"
+#include "FrameScheduler.h"
+#include "LatencyHistogram.h"
+#include "Timing.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
+#undef min
+#undef max
+
 #define MAX_LOADSTRING 100
 
 HINSTANCE hInst;								// current instance
@@ -40,7 +52,7 @@ HWND g_hMainWnd;
 HDC  g_hMainHDC;
 TCHAR szTitle[MAX_LOADSTRING];					// The title bar text
 TCHAR szWindowClass[MAX_LOADSTRING];			// the main window class name
-DWORD g_lastUpdate = 0;
+double g_lastUpdate = 0;
 int   g_frames = 0;
 
 int g_Width = 400;
@@ -56,6 +68,16 @@ enum drawType
 
 drawType g_DrawType = e_Cairo;
 
+// Per-frame render times of each renderer since the application started.
+LatencyHistogram g_frameTimes[e_CairoGL + 1];
+
+FrameClock g_frameClock;
+FrameContext g_lastFrame;
+
+// Frame rate of the last complete one second measurement.
+float g_intervalFps = 0;
+FrameScheduler g_scheduler;
+
 ATOM				MyRegisterClass(HINSTANCE hInstance);
 BOOL				InitInstance(HINSTANCE, int);
 LRESULT CALLBACK	WndProc(HWND, UINT, WPARAM, LPARAM);
@@ -76,21 +98,41 @@ IRenderTest* g_currentTest = 0;
 
 void render ()
 {
-   DWORD tickInterval = GetTickCount() - g_lastUpdate;
-   float fps = (tickInterval) ? g_frames / (tickInterval / 1000.0f) : 0;
+   double now = MonotonicTime();
+   double interval = now - g_lastUpdate;
+   float fps = (interval > 0.0) ? static_cast<float>(g_frames / interval) : 0;
+
+   LatencyHistogram& frameTimes = g_frameTimes[g_DrawType];
 
-   if (tickInterval > 1000)
+   if (interval >= 1.0)
    {
-      char message[100];
-      int length = sprintf(message, "fps: %0.2g\n", fps);
+      char summary[256];
+      frameTimes.formatSummary(summary, sizeof(summary));
+
+      char pacing[32];
+      g_scheduler.describe(pacing, sizeof(pacing));
+
+      char message[512];
+      sprintf(message, "fps: %0.2g frame time: %s pacing: %s jitter %.2f ms missed %llu\n", fps, summary,
+         pacing, g_scheduler.intervals().standardDeviation() * 1000.0, g_scheduler.missedDeadlines());
 
       OutputDebugStringA(message);
 
-      g_lastUpdate = GetTickCount();
+      g_lastUpdate = now;
       g_frames = 0;
+      g_intervalFps = fps;
    }
 
-   g_currentTest->RenderDemo (g_hMainWnd, g_hMainHDC, g_Height, g_Width, fps);
+   // Drawn on demand, a label that changed every frame would be a reason
+   // to draw another frame, so it only changes once per measurement.
+   if (g_scheduler.mode() == FrameScheduler::e_OnDemand)
+      fps = g_intervalFps;
+
+   FrameContext frame = g_frameClock.nextFrame(fps);
+   g_currentTest->RenderDemo (g_hMainWnd, g_hMainHDC, g_Height, g_Width, frame);
+   g_lastFrame = frame;
+
+   frameTimes.record(MonotonicTime() - now);
 
    ++g_frames;
 }
@@ -112,13 +154,91 @@ void SetClientSize(HWND hwnd, int clientWidth, int clientHeight)
                   SWP_NOZORDER | SWP_NOMOVE ) ;
 }
 
+// On demand, a frame is drawn once a hand would move by this many pixels,
+// and at least this often.
+static const double visibleMovement = 0.5;
+static const double onDemandMaxInterval = 60.0;
+
+/**
+  Seconds from now until the fps overlay of an on-demand frame would read
+  differently. It shows the rate of the last complete measurement, which
+  render() only closes when it draws a frame a second or more after the
+  previous one; the rate of the open measurement then decays until it
+  rounds to a different two digit value.
+*/
+static double SecondsUntilFpsLabelChanges(double now)
+{
+   if (!g_frames)
+      return HUGE_VAL;
+
+   char shown[32];
+   sprintf(shown, "%0.2g", g_intervalFps);
+
+   const double closes = g_lastUpdate + 1.0;
+   char next[32];
+   sprintf(next, "%0.2g", static_cast<float>(g_frames / 1.0));
+   if (strcmp(shown, next))
+      return closes - now;
+
+   // Lower edge of the range that prints as the same value: half a unit in
+   // the last printed digit below it. Just under a power of ten that digit
+   // is a decade smaller, e.g. 9.94 prints as "9.9" but 9.95 as "10".
+   const double printed = atof(next);
+   const double decade = std::pow(10.0, std::floor(std::log10(printed)));
+   const double unit = (printed == decade) ? decade / 100.0 : decade / 10.0;
+   const double lower = printed - unit / 2.0;
+   return g_lastUpdate + g_frames / lower - now;
+}
+
+/**
+  Schedules the next on-demand frame for when it would look different from
+  the last one: a hand has moved by half a pixel or the fps label changed.
+*/
+static void ScheduleVisibleChange()
+{
+   const double now = MonotonicTime();
+
+   ClockGrid grid(g_Width, g_Height, g_lastFrame.clocks);
+   double wait = std::min(SecondsUntilHandsMove(grid, g_lastFrame, visibleMovement), SecondsUntilFpsLabelChanges(now));
+
+   g_scheduler.scheduleFrame(now + std::min(wait, onDemandMaxInterval));
+}
+
+static void SetPacing (HWND hWnd, UINT menuId)
+{
+   switch (menuId)
+   {
+   case IDM_PACE_UNCAPPED:
+      g_scheduler.setUncapped();
+      break;
+   case IDM_PACE_120HZ:
+      g_scheduler.setFixedRate(120);
+      break;
+   case IDM_PACE_240HZ:
+      g_scheduler.setFixedRate(240);
+      break;
+   case IDM_PACE_ON_DEMAND:
+      g_scheduler.setOnDemand();
+      break;
+   case IDM_PACE_60HZ:
+   default:
+      menuId = IDM_PACE_60HZ;
+      g_scheduler.setFixedRate(60);
+      break;
+   }
+
+   ::CheckMenuRadioItem (::GetMenu(hWnd), IDM_PACE_UNCAPPED, IDM_PACE_ON_DEMAND, menuId, MF_BYCOMMAND);
+}
+
 int APIENTRY _tWinMain (HINSTANCE hInstance,
                         HINSTANCE hPrevInstance,
                         LPTSTR    lpCmdLine,
                         int       nCmdShow)
 {
 	UNREFERENCED_PARAMETER(hPrevInstance);
-	UNREFERENCED_PARAMETER(lpCmdLine);
+
+	if (IsBenchmarkCommandLine(lpCmdLine))
+		return RunBenchmarkFromCommandLine();
 
 	// Initialize global strings
 	LoadString (hInstance, IDS_APP_TITLE, szTitle, MAX_LOADSTRING);
@@ -134,25 +254,50 @@ int APIENTRY _tWinMain (HINSTANCE hInstance,
 	HACCEL hAccelTable = LoadAccelerators (hInstance, MAKEINTRESOURCE(IDC_D2DTEST));
 
 	MSG msg;
+	msg.wParam = 0;
 	bool running = true;
-	g_lastUpdate = ::GetTickCount();
+	g_lastUpdate = MonotonicTime();
 	
 	while (running)
 	{
 		if (PeekMessage (&msg, NULL, 0, 0, PM_REMOVE))
 		{
+			if (msg.message == WM_QUIT)
+				break;
+
 			if (!TranslateAccelerator (msg.hwnd, hAccelTable, &msg))
 			{
 				TranslateMessage (&msg);
 				DispatchMessage (&msg);
 			}
+			continue;
+		}
+
+		// Sleep until the next frame is close, waking up for any input, then
+		// spin the rest of the way so the frame starts on its deadline.
+		double wait = g_scheduler.timeUntilNextFrame();
+		if (wait < 0.0)
+		{
+			::MsgWaitForMultipleObjects (0, NULL, FALSE, INFINITE, QS_ALLINPUT);
+			continue;
 		}
-		else
+		if (wait > FrameScheduler::spinThreshold())
 		{
-			render();
-			::SwapBuffers(g_hMainHDC);
-			::Sleep(10);
+			DWORD milliseconds = static_cast<DWORD>((wait - FrameScheduler::spinThreshold()) * 1000.0);
+			::MsgWaitForMultipleObjects (0, NULL, FALSE, milliseconds, QS_ALLINPUT);
+			continue;
 		}
+
+		g_scheduler.spinUntilDue();
+		g_scheduler.beginFrame();
+		render();
+		::SwapBuffers(g_hMainHDC);
+		g_scheduler.endFrame();
+
+		// Nothing but the clock changes by itself; on demand, sleep until the
+		// next frame would visibly differ.
+		if (g_scheduler.mode() == FrameScheduler::e_OnDemand)
+			ScheduleVisibleChange();
 	}
 
 	return static_cast<int>(msg.wParam);
@@ -218,6 +363,8 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
    g_cairoGLRenderer = new CairoGLRenderer(g_hMainWnd, g_hMainHDC);
    g_currentTest = g_cairoRenderer;
 
+   SetPacing (g_hMainWnd, IDM_PACE_60HZ);
+
    return TRUE;
 }
 
@@ -251,6 +398,7 @@ static void SwitchDrawType (HWND hWnd, drawType changeToType)
    RECT rect;
    ::GetWindowRect (hWnd, &rect);
    ::InvalidateRect(hWnd, &rect, TRUE);
+   g_scheduler.invalidate();
 }
 
 //
@@ -295,6 +443,13 @@ LRESULT CALLBACK WndProc (HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 	  case IDM_CAIRO_GL:
 		  SwitchDrawType (hWnd, e_CairoGL);
 		  break;
+      case IDM_PACE_UNCAPPED:
+      case IDM_PACE_60HZ:
+      case IDM_PACE_120HZ:
+      case IDM_PACE_240HZ:
+      case IDM_PACE_ON_DEMAND:
+         SetPacing (hWnd, wmId);
+         break;
 
       default:
          return DefWindowProc (hWnd, message, wParam, lParam);
@@ -302,7 +457,7 @@ LRESULT CALLBACK WndProc (HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
       break;
    case WM_PAINT:
       hdc = ::BeginPaint (hWnd, &ps);
-      g_currentTest->RenderDemo(hWnd, hdc, g_Height, g_Width, 0.0f);
+      g_currentTest->RenderDemo(hWnd, hdc, g_Height, g_Width, g_frameClock.nextFrame(0.0f));
       ::EndPaint (hWnd, &ps);
       break;
    case WM_SIZE:
@@ -321,6 +476,7 @@ LRESULT CALLBACK WndProc (HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
          ::InvalidateRect(hWnd, 0, FALSE);
          render();
+         g_scheduler.invalidate();
       }
       break;
    case WM_SIZING:
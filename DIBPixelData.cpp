@@ -50,6 +50,20 @@ void DIBPixelData::initialize(HBITMAP bitmap)
 	m_size.cy = bmpInfo.bmHeight;
     m_bytesPerRow = bmpInfo.bmWidthBytes;
     m_bitsPerPixel = bmpInfo.bmBitsPixel;
+
+    // Bottom-up DIBs store the last row first.
+    DIBSECTION section;
+    m_bottomUp = GetObject(bitmap, sizeof(section), &section) == sizeof(section) && section.dsBmih.biHeight > 0;
+}
+
+PixelBufferView DIBPixelData::view() const
+{
+    PixelFormat format = m_bitsPerPixel == 32 ? e_PixelFormatARGB32 : e_PixelFormatInvalid;
+    if (!m_bottomUp)
+        return PixelBufferView(m_bitmapBuffer, m_size.cx, m_size.cy, m_bytesPerRow, format);
+
+    const ptrdiff_t stride = m_bytesPerRow;
+    return PixelBufferView(m_bitmapBuffer + (m_size.cy - 1) * stride, m_size.cx, m_size.cy, -stride, format);
 }
 
 #ifndef NDEBUG
@@ -95,54 +109,10 @@ void DIBPixelData::setRGBABitmapAlpha(HDC hdc, const RECT& dstRect, unsigned cha
 
     XFORM trans;
     GetWorldTransform(hdc, &trans);
-    SIZE transformedPosition;
-	transformedPosition.cx = trans.eDx;
-	transformedPosition.cy = trans.eDy;
-
-	RECT drawRect (dstRect);
-    drawRect.left += transformedPosition.cx;
-	drawRect.top += transformedPosition.cy;
-
-    int pixelDataWidth = pixelData.size().cx;
-    int pixelDataHeight = pixelData.size().cy;
-	RECT bitmapRect = { 0, 0, pixelDataWidth, pixelDataHeight };
-
-    int l = std::max(drawRect.left, bitmapRect.left);
-    int t = std::max(drawRect.bottom, bitmapRect.bottom);
-    int r = std::min(drawRect.right, bitmapRect.right);
-    int b = std::min(drawRect.top, bitmapRect.top);
-
-    // Return a clean empty rectangle for non-intersecting cases.
-    if (l >= r || t >= b) {
-        l = 0;
-        t = 0;
-        r = 0;
-        b = 0;
-    }
-
-	drawRect.left = l;
-	drawRect.bottom = t;
-	drawRect.right = r;
-	drawRect.top = t;
-
-    if ((drawRect.right - drawRect.left <= 0) ||
-		(drawRect.top - drawRect.bottom <= 0))
-	{
-        return;
-	}
-
-    RGBQUAD* bytes = reinterpret_cast<RGBQUAD*>(pixelData.buffer());
-    bytes += drawRect.top * pixelDataWidth;
-
-    size_t width = drawRect.right - drawRect.left;
-    size_t height = drawRect.top - drawRect.bottom;
-    int x = drawRect.left;
-    for (size_t i = 0; i < height; i++) {
-        RGBQUAD* p = bytes + x;
-        for (size_t j = 0; j < width; j++) {
-            p->rgbReserved = level;
-            p++;
-        }
-        bytes += pixelDataWidth;
-    }
+    const int dx = static_cast<int>(trans.eDx);
+    const int dy = static_cast<int>(trans.eDy);
+
+    // dstRect in bitmap coordinates; the view clips it to the bitmap.
+    PixelRect drawRect = { dstRect.left + dx, dstRect.top + dy, dstRect.right + dx, dstRect.bottom + dy };
+    SetPixelAlpha(pixelData.view().subView(drawRect), level);
 }
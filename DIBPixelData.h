@@ -26,6 +26,8 @@
 #ifndef DIBPixelData_h
 #define DIBPixelData_h
 
+#include "PixelBufferView.h"
+
 #include <windows.h>
 
 #include <CoreFoundation/CFBase.h>
@@ -37,6 +39,7 @@ class DIBPixelData {
             , m_bitmapBufferLength(0)
             , m_bytesPerRow(0)
             , m_bitsPerPixel(0)
+            , m_bottomUp(false)
         {
         }
         DIBPixelData(HBITMAP);
@@ -52,6 +55,10 @@ class DIBPixelData {
         const SIZE& size() const { return m_size; }
         unsigned bytesPerRow() const { return m_bytesPerRow; }
         unsigned short bitsPerPixel() const { return m_bitsPerPixel; }
+
+        // The pixels with row 0 at the top, whichever way the DIB is stored.
+        PixelBufferView view() const;
+
         static void setRGBABitmapAlpha(HDC, const RECT&, unsigned char);
 
     private:
@@ -60,6 +67,7 @@ class DIBPixelData {
         SIZE m_size;
         unsigned m_bytesPerRow;
         unsigned short m_bitsPerPixel;
+        bool m_bottomUp;
 };
 
 #endif // DIBPixelData_h
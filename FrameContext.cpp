@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "FrameContext.h"
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <sys/time.h>
+#include <time.h>
+#endif
+
+static const double secondsPerDay = 24 * 60 * 60;
+
+// Just before ten past ten, the traditional time to photograph a clock,
+// with the second hand pointing down.
+static const double defaultStartTime = 10 * 3600 + 8 * 60 + 30;
+static const double defaultStep = 1.0 / 60.0;
+static const float defaultScriptedFPS = 60.0f;
+
+// A prime number of seconds, so that neighbouring clocks look unrelated.
+static const double clockTimeOffset = 7919.0;
+
+static double LocalTimeOfDay()
+{
+#if defined(_WIN32)
+   SYSTEMTIME time;
+   GetLocalTime(&time);
+
+   return time.wHour * 3600.0 + time.wMinute * 60.0 + time.wSecond + time.wMilliseconds / 1000.0;
+#else
+   struct timeval now;
+   gettimeofday(&now, 0);
+
+   struct tm local;
+   localtime_r(&now.tv_sec, &local);
+
+   return local.tm_hour * 3600.0 + local.tm_min * 60.0 + local.tm_sec + now.tv_usec / 1.0e6;
+#endif
+}
+
+FrameContext::FrameContext()
+   : timeOfDay(0.0), fps(0.0f), frameNumber(0), clocks(1)
+{
+   hands = HandsForTime(timeOfDay);
+}
+
+ClockHands FrameContext::handsForClock(unsigned index) const
+{
+   if (!index)
+      return hands;
+
+   return HandsForTime(timeOfDay + index * clockTimeOffset);
+}
+
+ClockHands FrameContext::HandsForTime(double timeOfDay)
+{
+   timeOfDay = std::fmod(timeOfDay, secondsPerDay);
+   if (timeOfDay < 0.0)
+      timeOfDay += secondsPerDay;
+
+   // The minute hand moves smoothly with the seconds, and the hour hand with
+   // the whole minutes, as the original drawing code did.
+   double hours = std::floor(timeOfDay / 3600.0) * M_PI / 6;
+   double minutes = std::fmod(std::floor(timeOfDay / 60.0), 60.0) * M_PI / 30;
+   double seconds = std::fmod(timeOfDay, 60.0) * M_PI / 30;
+
+   ClockHands hands;
+   hands.hours = hours + minutes / 12.0;
+   hands.minutes = minutes + seconds / 60;
+   hands.seconds = seconds;
+   return hands;
+}
+
+FrameClock::FrameClock()
+   : m_mode(e_WallClock), m_startTime(defaultStartTime), m_step(defaultStep), m_frameNumber(0)
+{
+}
+
+void FrameClock::setWallClock()
+{
+   m_mode = e_WallClock;
+   m_frameNumber = 0;
+}
+
+void FrameClock::setFixedStep(double startTime, double step)
+{
+   m_mode = e_FixedStep;
+   m_startTime = startTime;
+   m_step = step;
+   m_frameNumber = 0;
+}
+
+/**
+  One number of a time of day. Unlike plain strtod it needs a digit first,
+  so empty fields, signs, spaces and "inf" are rejected.
+*/
+static bool ParseTimeField(const char* text, double& value, char** next)
+{
+   if (!isdigit(static_cast<unsigned char>(*text)))
+      return false;
+
+   value = strtod(text, next);
+   return true;
+}
+
+static bool ParseTimeOfDay(const char* text, double& timeOfDay, const char** end)
+{
+   char* next = 0;
+   double value = 0.0;
+   if (!ParseTimeField(text, value, &next))
+      return false;
+
+   // HH:MM:SS[.fff]
+   if (*next == ':')
+   {
+      double hours = value;
+      double minutes = 0.0;
+      double seconds = 0.0;
+      if (!ParseTimeField(next + 1, minutes, &next) || *next != ':')
+         return false;
+      if (!ParseTimeField(next + 1, seconds, &next))
+         return false;
+      value = hours * 3600 + minutes * 60 + seconds;
+   }
+
+   timeOfDay = value;
+   *end = next;
+   return true;
+}
+
+bool FrameClock::loadScript(const std::string& path)
+{
+   FILE* in = fopen(path.c_str(), "r");
+   if (!in)
+   {
+      fprintf(stderr, "could not open time script '%s'\n", path.c_str());
+      return false;
+   }
+
+   std::vector<ScriptedFrame> script;
+   char line[256];
+   int lineNumber = 0;
+   while (fgets(line, sizeof(line), in))
+   {
+      ++lineNumber;
+
+      const char* text = line;
+      while (*text == ' ' || *text == '\t')
+         ++text;
+      if (!*text || *text == '\n' || *text == '\r' || *text == '#')
+         continue;
+
+      ScriptedFrame frame;
+      const char* end = 0;
+      if (!ParseTimeOfDay(text, frame.timeOfDay, &end))
+      {
+         fprintf(stderr, "%s:%d: expected a time of day\n", path.c_str(), lineNumber);
+         fclose(in);
+         return false;
+      }
+
+      char* fpsEnd = 0;
+      double fps = strtod(end, &fpsEnd);
+      frame.fps = fpsEnd != end ? static_cast<float>(fps) : defaultScriptedFPS;
+
+      script.push_back(frame);
+   }
+   fclose(in);
+
+   if (script.empty())
+   {
+      fprintf(stderr, "time script '%s' has no frames\n", path.c_str());
+      return false;
+   }
+
+   m_mode = e_Scripted;
+   m_script.swap(script);
+   m_frameNumber = 0;
+   return true;
+}
+
+bool FrameClock::configure(const std::string& description)
+{
+   if (description == "wall")
+   {
+      setWallClock();
+      return true;
+   }
+
+   if (!description.compare(0, 7, "script:"))
+      return loadScript(description.substr(7));
+
+   if (description.compare(0, 5, "fixed"))
+      return false;
+
+   double startTime = defaultStartTime;
+   double step = defaultStep;
+
+   const char* text = description.c_str() + 5;
+   if (*text == ':')
+   {
+      const char* end = 0;
+      if (!ParseTimeOfDay(text + 1, startTime, &end))
+         return false;
+      text = end;
+   }
+
+   if (*text == ',')
+   {
+      char* end = 0;
+      step = strtod(text + 1, &end);
+      if (end == text + 1 || step <= 0.0)
+         return false;
+      text = end;
+   }
+
+   if (*text)
+      return false;
+
+   setFixedStep(startTime, step);
+   return true;
+}
+
+FrameContext FrameClock::nextFrame(float measuredFPS)
+{
+   FrameContext frame;
+   frame.frameNumber = m_frameNumber;
+
+   switch (m_mode)
+   {
+   case e_FixedStep:
+      frame.timeOfDay = m_startTime + m_frameNumber * m_step;
+      frame.fps = static_cast<float>(1.0 / m_step);
+      break;
+   case e_Scripted:
+      {
+         const ScriptedFrame& scripted = m_script[m_frameNumber % m_script.size()];
+         frame.timeOfDay = scripted.timeOfDay;
+         frame.fps = scripted.fps;
+      }
+      break;
+   case e_WallClock:
+   default:
+      frame.timeOfDay = LocalTimeOfDay();
+      frame.fps = measuredFPS;
+      break;
+   }
+
+   frame.hands = FrameContext::HandsForTime(frame.timeOfDay);
+
+   ++m_frameNumber;
+   return frame;
+}
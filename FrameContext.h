@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+  Angles of the clock hands, in radians clockwise from twelve o'clock.
+*/
+struct ClockHands
+{
+   double hours;
+   double minutes;
+   double seconds;
+};
+
+/**
+  Everything a RenderDemo implementation needs to know about the frame it is
+  drawing. Renderers must not query the time themselves, so that frames can
+  be reproduced exactly.
+*/
+struct FrameContext
+{
+   FrameContext();
+
+   static ClockHands HandsForTime(double timeOfDay);
+
+   /**
+     Hands of clock number index in a multi-clock scene. Every clock runs
+     at its own fixed offset from timeOfDay; clock 0 shows hands.
+   */
+   ClockHands handsForClock(unsigned index) const;
+
+   double timeOfDay;       // simulated seconds since midnight
+   ClockHands hands;
+   float fps;              // value shown in the overlay
+   unsigned frameNumber;
+   unsigned clocks;        // number of clocks in the scene, see ClockGrid
+};
+
+/**
+  Produces the FrameContext of successive frames.
+
+  e_WallClock follows the local time, as the interactive window does.
+  e_FixedStep starts at a given time of day and advances by a fixed step per
+  frame, showing the matching fps. e_Scripted replays a list of times (and
+  optionally fps values) read from a file, wrapping around at the end.
+*/
+class FrameClock
+{
+public:
+   enum Mode
+   {
+      e_WallClock,
+      e_FixedStep,
+      e_Scripted
+   };
+
+   FrameClock();
+
+   Mode mode() const { return m_mode; }
+
+   void setWallClock();
+   void setFixedStep(double startTime, double step);
+
+   /**
+     Reads one frame per line: a time of day, either as seconds since
+     midnight or as HH:MM:SS[.fff], optionally followed by the fps to show.
+     Blank lines and lines starting with '#' are ignored.
+   */
+   bool loadScript(const std::string& path);
+
+   /**
+     Parses "wall", "fixed[:<start>[,<step>]]" or "script:<file>", where
+     start is a time of day and step is in seconds.
+   */
+   bool configure(const std::string& description);
+
+   void rewind() { m_frameNumber = 0; }
+
+   // measuredFPS is only shown in e_WallClock mode.
+   FrameContext nextFrame(float measuredFPS);
+
+private:
+   struct ScriptedFrame
+   {
+      double timeOfDay;
+      float fps;
+   };
+
+   Mode m_mode;
+   double m_startTime;
+   double m_step;
+   std::vector<ScriptedFrame> m_script;
+   unsigned m_frameNumber;
+};
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "FrameScheduler.h"
+
+#include "Timing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#undef min
+#undef max
+
+#if defined(_WIN32)
+#include <mmsystem.h>
+#else
+#include <time.h>
+#endif
+
+// Sleep() is only trusted to within a couple of milliseconds once the system
+// timer resolution has been raised with timeBeginPeriod(1).
+static const double defaultSpinThreshold = 0.002;
+
+static void RaiseTimerResolution()
+{
+#if defined(_WIN32)
+   // The default 15.6ms tick would make every 60Hz frame sleep past its
+   // deadline. The raised resolution lasts until the process exits.
+   static bool raised = false;
+   if (!raised)
+   {
+      ::timeBeginPeriod(1);
+      raised = true;
+   }
+#endif
+}
+
+static void SleepSeconds(double seconds)
+{
+#if defined(_WIN32)
+   ::Sleep(static_cast<DWORD>(seconds * 1000.0));
+#else
+   struct timespec delay;
+   delay.tv_sec = static_cast<time_t>(seconds);
+   delay.tv_nsec = static_cast<long>((seconds - delay.tv_sec) * 1.0e9);
+   nanosleep(&delay, 0);
+#endif
+}
+
+FrameScheduler::FrameScheduler()
+   : m_mode(e_Uncapped)
+   , m_period(0.0)
+   , m_deadline(0.0)
+   , m_frameStart(0.0)
+   , m_previousStart(0.0)
+   , m_pending(false)
+   , m_frames(0)
+   , m_missedDeadlines(0)
+{
+}
+
+void FrameScheduler::setUncapped()
+{
+   m_mode = e_Uncapped;
+   m_period = 0.0;
+   reset();
+}
+
+void FrameScheduler::setFixedRate(double framesPerSecond)
+{
+   RaiseTimerResolution();
+
+   m_mode = e_FixedRate;
+   m_period = 1.0 / framesPerSecond;
+   reset();
+}
+
+void FrameScheduler::setOnDemand()
+{
+   RaiseTimerResolution();
+
+   m_mode = e_OnDemand;
+   m_period = 0.0;
+   reset();
+   m_pending = true;
+}
+
+bool FrameScheduler::configure(const std::string& description)
+{
+   if (description == "uncapped")
+   {
+      setUncapped();
+      return true;
+   }
+
+   if (description == "ondemand")
+   {
+      setOnDemand();
+      return true;
+   }
+
+   char* end = 0;
+   double rate = strtod(description.c_str(), &end);
+   if (end == description.c_str() || *end || rate <= 0.0)
+      return false;
+
+   setFixedRate(rate);
+   return true;
+}
+
+void FrameScheduler::invalidate()
+{
+   scheduleFrame(MonotonicTime());
+}
+
+void FrameScheduler::scheduleFrame(double time)
+{
+   if (!m_pending || time < m_deadline)
+      m_deadline = time;
+   m_pending = true;
+}
+
+double FrameScheduler::timeUntilNextFrame() const
+{
+   switch (m_mode)
+   {
+   case e_FixedRate:
+      if (!m_deadline)
+         return 0.0;
+      return std::max(m_deadline - MonotonicTime(), 0.0);
+   case e_OnDemand:
+      if (!m_pending)
+         return -1.0;
+      return std::max(m_deadline - MonotonicTime(), 0.0);
+   case e_Uncapped:
+   default:
+      return 0.0;
+   }
+}
+
+bool FrameScheduler::waitForNextFrame()
+{
+   double remaining = timeUntilNextFrame();
+   if (remaining < 0.0)
+      return false;
+
+   if (remaining > defaultSpinThreshold)
+      SleepSeconds(remaining - defaultSpinThreshold);
+
+   spinUntilDue();
+   return true;
+}
+
+void FrameScheduler::spinUntilDue()
+{
+   if (m_mode == e_Uncapped || !m_deadline)
+      return;
+
+   while (MonotonicTime() < m_deadline)
+      ;
+}
+
+double FrameScheduler::spinThreshold()
+{
+   return defaultSpinThreshold;
+}
+
+void FrameScheduler::beginFrame()
+{
+   m_frameStart = MonotonicTime();
+
+   if (m_previousStart)
+      m_intervals.record(m_frameStart - m_previousStart);
+   m_previousStart = m_frameStart;
+
+   if (m_mode == e_FixedRate)
+   {
+      // The first frame defines the phase of all later deadlines.
+      if (!m_deadline)
+         m_deadline = m_frameStart;
+      m_startError.record(std::max(m_frameStart - m_deadline, 0.0));
+   }
+   else if (m_mode == e_OnDemand)
+      m_pending = false;
+}
+
+void FrameScheduler::endFrame()
+{
+   ++m_frames;
+
+   if (m_mode != e_FixedRate)
+      return;
+
+   double now = MonotonicTime();
+   m_deadline += m_period;
+   if (now <= m_deadline)
+      return;
+
+   // The frame overran its slot: count every period it swallowed and line the
+   // next deadline up with the original phase.
+   double lost = std::floor((now - m_deadline) / m_period) + 1.0;
+   m_missedDeadlines += static_cast<unsigned long long>(lost);
+   m_deadline += lost * m_period;
+}
+
+void FrameScheduler::reset()
+{
+   m_deadline = 0.0;
+   m_frameStart = 0.0;
+   m_previousStart = 0.0;
+   m_pending = false;
+   m_frames = 0;
+   m_missedDeadlines = 0;
+   m_startError.reset();
+   m_intervals.reset();
+}
+
+void FrameScheduler::describe(char* buffer, size_t length) const
+{
+   switch (m_mode)
+   {
+   case e_FixedRate:
+      snprintf(buffer, length, "%g Hz", targetRate());
+      break;
+   case e_OnDemand:
+      snprintf(buffer, length, "on demand");
+      break;
+   case e_Uncapped:
+   default:
+      snprintf(buffer, length, "uncapped");
+      break;
+   }
+   buffer[length - 1] = 0;
+}
+
+void FrameScheduler::writeReport(FILE* out) const
+{
+   char mode[32];
+   describe(mode, sizeof(mode));
+
+   fprintf(out, "pacing     : %s\n", mode);
+   fprintf(out, "interval   : ");
+   m_intervals.writeSummary(out);
+
+   if (m_mode != e_FixedRate)
+      return;
+
+   fprintf(out, "start error: ");
+   m_startError.writeSummary(out);
+   fprintf(out, "missed     : %llu of %llu deadlines (%.1f%%)\n", m_missedDeadlines, m_frames + m_missedDeadlines,
+      m_frames ? 100.0 * m_missedDeadlines / (m_frames + m_missedDeadlines) : 0.0);
+}
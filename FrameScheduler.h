@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include "LatencyHistogram.h"
+
+#include <cstdio>
+#include <string>
+
+/**
+  Decides when the next frame should be drawn and measures how well the
+  actual frame starts follow that plan.
+
+  e_Uncapped draws frames back to back. e_FixedRate aims every frame start at
+  a deadline one period after the previous one, sleeping for most of the gap
+  and spinning for the last couple of milliseconds. e_OnDemand only draws once
+  invalidate() or scheduleFrame() asked for a frame.
+
+  A deadline is missed when a frame has not finished before the following
+  deadline; the scheduler then skips the lost periods rather than trying to
+  catch up with a burst of frames.
+*/
+class FrameScheduler
+{
+public:
+   enum Mode
+   {
+      e_Uncapped,
+      e_FixedRate,
+      e_OnDemand
+   };
+
+   FrameScheduler();
+
+   Mode mode() const { return m_mode; }
+   double targetRate() const { return m_mode == e_FixedRate ? 1.0 / m_period : 0.0; }
+
+   void setUncapped();
+   void setFixedRate(double framesPerSecond);
+   void setOnDemand();
+
+   /**
+     Parses "uncapped", "ondemand" or a target rate in Hz such as "60".
+   */
+   bool configure(const std::string& description);
+
+   // Requests a frame as soon as possible, or at the given MonotonicTime().
+   // Only meaningful in e_OnDemand mode; the other modes always have one due.
+   void invalidate();
+   void scheduleFrame(double time);
+
+   /**
+     Seconds until the next frame is due: zero if it is due now, negative if
+     nothing is scheduled (e_OnDemand with no pending request).
+   */
+   double timeUntilNextFrame() const;
+
+   /**
+     Blocks until the next frame is due. Sleeps while more than
+     spinThreshold() seconds remain, then spins. Returns false if no frame is
+     scheduled.
+   */
+   bool waitForNextFrame();
+
+   // Spins away the last spinThreshold() seconds before the deadline.
+   void spinUntilDue();
+
+   static double spinThreshold();
+
+   void beginFrame();
+   void endFrame();
+
+   void reset();
+
+   unsigned long long frames() const { return m_frames; }
+   unsigned long long missedDeadlines() const { return m_missedDeadlines; }
+
+   // How late each frame started relative to its deadline (e_FixedRate).
+   const LatencyHistogram& startError() const { return m_startError; }
+   // Time between successive frame starts; its deviation is the pacing jitter.
+   const LatencyHistogram& intervals() const { return m_intervals; }
+
+   void describe(char* buffer, size_t length) const;
+   void writeReport(FILE*) const;
+
+private:
+   Mode m_mode;
+   double m_period;
+   double m_deadline;
+   double m_frameStart;
+   double m_previousStart;
+   bool m_pending;
+
+   unsigned long long m_frames;
+   unsigned long long m_missedDeadlines;
+   LatencyHistogram m_startError;
+   LatencyHistogram m_intervals;
+};
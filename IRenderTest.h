@@ -24,12 +24,31 @@
  */
 #pragma once;
 
+#include "FrameContext.h"
+
 #include <Windows.h>
 
+#include <cstdio>
+
 class IRenderTest
 {
 public:
-	virtual void RenderDemo(HWND hWnd, HDC hdc, int height, int width, float fps) = 0;
+	virtual ~IRenderTest() {}
+
+	virtual void RenderDemo(HWND hWnd, HDC hdc, int height, int width, const FrameContext& frame) = 0;
 	virtual void ResizeDemo(HWND hWnd, const RECT& rect) = 0;
 	virtual void InitDemo(HWND hWnd, HDC hdc) = 0;
+
+	// Renderers that gather their own measurements print them here.
+	virtual void ResetStatistics() {}
+	virtual void WriteStatistics(FILE*) {}
+
+	// Replays a retained ClockDisplayList instead of drawing the scene
+	// directly. Returns false if the renderer has no display list player, or
+	// its current settings would draw the scene some other way.
+	virtual bool SetDisplayListMode(bool enabled) { return !enabled; }
+
+	// Records the following frames into a cairo-script trace at path, or
+	// stops if path is 0. Returns false if the renderer cannot record one.
+	virtual bool SetScriptCapture(const char* path) { return !path; }
 };
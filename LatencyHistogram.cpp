@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#undef min
+#undef max
+
+static const unsigned subBucketBits = 5;
+static const unsigned long long subBucketCount = 1ull << subBucketBits;
+
+// Values of 2^largestMagnitude ns (about 5 hours) and above share the last bucket.
+static const unsigned largestMagnitude = 44;
+static const size_t bucketCount = static_cast<size_t>(2 * subBucketCount + (largestMagnitude - subBucketBits - 1) * subBucketCount);
+
+static const double nanosecondsPerSecond = 1.0e9;
+
+static unsigned HighestBit(unsigned long long value)
+{
+   unsigned bit = 0;
+   while (value >>= 1)
+      ++bit;
+   return bit;
+}
+
+LatencyHistogram::LatencyHistogram()
+   : m_buckets(bucketCount, 0)
+{
+   reset();
+}
+
+void LatencyHistogram::reset()
+{
+   std::fill(m_buckets.begin(), m_buckets.end(), 0);
+   m_count = 0;
+   m_minimum = ~0ull;
+   m_maximum = 0;
+   m_sum = 0.0;
+   m_sumOfSquares = 0.0;
+}
+
+size_t LatencyHistogram::bucketIndex(unsigned long long nanoseconds)
+{
+   if (nanoseconds < 2 * subBucketCount)
+      return static_cast<size_t>(nanoseconds);
+
+   unsigned magnitude = HighestBit(nanoseconds);
+   if (magnitude >= largestMagnitude)
+      return bucketCount - 1;
+
+   unsigned shift = magnitude - subBucketBits;
+   unsigned long long subBucket = (nanoseconds >> shift) - subBucketCount;
+   return static_cast<size_t>(2 * subBucketCount + (shift - 1) * subBucketCount + subBucket);
+}
+
+unsigned long long LatencyHistogram::bucketLowerBound(size_t index)
+{
+   if (index < 2 * subBucketCount)
+      return index;
+
+   size_t offset = index - static_cast<size_t>(2 * subBucketCount);
+   unsigned shift = static_cast<unsigned>(offset / subBucketCount) + 1;
+   return (subBucketCount + offset % subBucketCount) << shift;
+}
+
+unsigned long long LatencyHistogram::bucketUpperBound(size_t index)
+{
+   if (index + 1 >= bucketCount)
+      return ~0ull;
+
+   return bucketLowerBound(index + 1);
+}
+
+void LatencyHistogram::record(double seconds)
+{
+   if (seconds < 0.0)
+      seconds = 0.0;
+
+   unsigned long long nanoseconds = static_cast<unsigned long long>(seconds * nanosecondsPerSecond + 0.5);
+
+   ++m_buckets[bucketIndex(nanoseconds)];
+   ++m_count;
+   m_minimum = std::min(m_minimum, nanoseconds);
+   m_maximum = std::max(m_maximum, nanoseconds);
+   m_sum += seconds;
+   m_sumOfSquares += seconds * seconds;
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other)
+{
+   for (size_t i = 0; i < bucketCount; ++i)
+      m_buckets[i] += other.m_buckets[i];
+
+   m_count += other.m_count;
+   m_minimum = std::min(m_minimum, other.m_minimum);
+   m_maximum = std::max(m_maximum, other.m_maximum);
+   m_sum += other.m_sum;
+   m_sumOfSquares += other.m_sumOfSquares;
+}
+
+double LatencyHistogram::minimum() const
+{
+   return m_count ? m_minimum / nanosecondsPerSecond : 0.0;
+}
+
+double LatencyHistogram::maximum() const
+{
+   return m_maximum / nanosecondsPerSecond;
+}
+
+double LatencyHistogram::mean() const
+{
+   return m_count ? m_sum / m_count : 0.0;
+}
+
+double LatencyHistogram::standardDeviation() const
+{
+   if (m_count < 2)
+      return 0.0;
+
+   double average = mean();
+   double variance = m_sumOfSquares / m_count - average * average;
+   return variance > 0.0 ? std::sqrt(variance) : 0.0;
+}
+
+double LatencyHistogram::percentile(double percent) const
+{
+   if (!m_count)
+      return 0.0;
+
+   if (percent <= 0.0)
+      return minimum();
+   if (percent >= 100.0)
+      return maximum();
+
+   unsigned long long rank = static_cast<unsigned long long>(std::ceil(percent / 100.0 * m_count));
+   if (!rank)
+      rank = 1;
+
+   unsigned long long seen = 0;
+   for (size_t i = 0; i < bucketCount; ++i)
+   {
+      seen += m_buckets[i];
+      if (seen < rank)
+         continue;
+
+      // Report the middle of the bucket, but never outside what was recorded.
+      unsigned long long lower = std::max(bucketLowerBound(i), m_minimum);
+      unsigned long long upper = std::min(bucketUpperBound(i) - 1, m_maximum);
+      return (lower + (upper - lower) / 2) / nanosecondsPerSecond;
+   }
+
+   return maximum();
+}
+
+void LatencyHistogram::formatSummary(char* buffer, size_t length) const
+{
+   const double ms = 1000.0;
+   snprintf(buffer, length,
+      "min %.3f p50 %.3f p90 %.3f p99 %.3f p99.9 %.3f max %.3f jitter %.3f ms",
+      minimum() * ms, percentile(50.0) * ms, percentile(90.0) * ms, percentile(99.0) * ms,
+      percentile(99.9) * ms, maximum() * ms, standardDeviation() * ms);
+   buffer[length - 1] = 0;
+}
+
+void LatencyHistogram::writeSummary(FILE* out) const
+{
+   char summary[256];
+   formatSummary(summary, sizeof(summary));
+   fprintf(out, "%s\n", summary);
+}
+
+void LatencyHistogram::writeJSON(FILE* out) const
+{
+   fprintf(out, "{\n");
+   fprintf(out, "  \"count\": %llu,\n", m_count);
+   fprintf(out, "  \"min_ns\": %llu,\n", m_count ? m_minimum : 0ull);
+   fprintf(out, "  \"max_ns\": %llu,\n", m_maximum);
+   fprintf(out, "  \"mean_ns\": %.1f,\n", mean() * nanosecondsPerSecond);
+   fprintf(out, "  \"stddev_ns\": %.1f,\n", standardDeviation() * nanosecondsPerSecond);
+   fprintf(out, "  \"percentiles_ns\": { \"50\": %.0f, \"90\": %.0f, \"99\": %.0f, \"99.9\": %.0f },\n",
+           percentile(50.0) * nanosecondsPerSecond, percentile(90.0) * nanosecondsPerSecond,
+           percentile(99.0) * nanosecondsPerSecond, percentile(99.9) * nanosecondsPerSecond);
+   fprintf(out, "  \"buckets\": [");
+
+   const char* separator = "\n";
+   for (size_t i = 0; i < bucketCount; ++i)
+   {
+      if (!m_buckets[i])
+         continue;
+
+      fprintf(out, "%s    { \"lower_ns\": %llu, \"upper_ns\": %llu, \"count\": %llu }",
+              separator, bucketLowerBound(i), bucketUpperBound(i), m_buckets[i]);
+      separator = ",\n";
+   }
+
+   fprintf(out, "\n  ]\n}\n");
+}
+
+void LatencyHistogram::writeCSV(FILE* out) const
+{
+   fprintf(out, "lower_ns,upper_ns,count\n");
+   for (size_t i = 0; i < bucketCount; ++i)
+   {
+      if (m_buckets[i])
+         fprintf(out, "%llu,%llu,%llu\n", bucketLowerBound(i), bucketUpperBound(i), m_buckets[i]);
+   }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+/**
+  Log-bucketed (HDR style) histogram of frame latencies.
+
+  Values are kept in nanoseconds. Below 64ns every value has its own bucket;
+  above that each power of two is split into 32 linear sub-buckets, so any
+  reported percentile is within about 3% of the recorded value while the
+  whole range up to several hours fits in a little over a thousand counters.
+*/
+class LatencyHistogram
+{
+public:
+   LatencyHistogram();
+
+   void record(double seconds);
+   void add(const LatencyHistogram&);
+   void reset();
+
+   unsigned long long count() const { return m_count; }
+
+   // All statistics are reported in seconds.
+   double minimum() const;
+   double maximum() const;
+   double mean() const;
+   double standardDeviation() const;
+   double percentile(double percent) const;
+
+   /**
+     Prints a single line such as
+     "min 1.02 p50 1.10 p90 1.31 p99 2.80 p99.9 4.12 max 5.00 jitter 0.21 ms".
+   */
+   void writeSummary(FILE*) const;
+   void formatSummary(char* buffer, size_t length) const;
+
+   // Raw dumps of every non-empty bucket, for offline plotting.
+   void writeJSON(FILE*) const;
+   void writeCSV(FILE*) const;
+
+private:
+   static size_t bucketIndex(unsigned long long nanoseconds);
+   static unsigned long long bucketLowerBound(size_t index);
+   static unsigned long long bucketUpperBound(size_t index);
+
+   std::vector<unsigned long long> m_buckets;
+   unsigned long long m_count;
+   unsigned long long m_minimum;
+   unsigned long long m_maximum;
+   double m_sum;
+   double m_sumOfSquares;
+};
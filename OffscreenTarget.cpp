@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "OffscreenTarget.h"
+
+static const TCHAR offscreenWindowClass[] = TEXT("D2DTestOffscreen");
+
+/**
+  Each /instances worker builds its own target, so several threads can get
+  here at once; whichever loses the race finds the class already there.
+*/
+static bool RegisterOffscreenWindowClass()
+{
+   WNDCLASSEX wcex;
+   memset(&wcex, 0x00, sizeof(wcex));
+   wcex.cbSize = sizeof(WNDCLASSEX);
+   wcex.style = CS_OWNDC;
+   wcex.lpfnWndProc = DefWindowProc;
+   wcex.hInstance = ::GetModuleHandle(0);
+   wcex.lpszClassName = offscreenWindowClass;
+
+   return ::RegisterClassEx(&wcex) || ::GetLastError() == ERROR_CLASS_ALREADY_EXISTS;
+}
+
+OffscreenTarget::OffscreenTarget(int width, int height)
+   : m_width(width), m_height(height), m_window(0), m_windowDC(0), m_bitmapDC(0),
+   m_bitmap(0), m_oldBitmap(0), m_bitmapData(0)
+{
+   if (!RegisterOffscreenWindowClass())
+      return;
+
+   // A popup window has no decorations, so its client area is exactly the
+   // requested size, and it is not clamped to the size of the desktop.
+   m_window = ::CreateWindowEx(0, offscreenWindowClass, TEXT(""), WS_POPUP,
+                               0, 0, width, height, 0, 0, ::GetModuleHandle(0), 0);
+   if (!m_window)
+      return;
+
+   m_windowDC = ::GetDC(m_window);
+
+   PIXELFORMATDESCRIPTOR pfd;
+   memset(&pfd, 0x00, sizeof(pfd));
+   pfd.nSize = sizeof(pfd);
+   pfd.nVersion = 1;
+   pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+   pfd.iPixelType = PFD_TYPE_RGBA;
+   pfd.cColorBits = 24;
+   pfd.cDepthBits = 16;
+   pfd.iLayerType = PFD_MAIN_PLANE;
+   int iFormat = ::ChoosePixelFormat(m_windowDC, &pfd);
+   ::SetPixelFormat(m_windowDC, iFormat, &pfd);
+
+   m_bitmapDC = ::CreateCompatibleDC(m_windowDC);
+
+   BITMAPINFO bmpInfo;
+   memset(&bmpInfo, 0x00, sizeof(bmpInfo));
+   bmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+   bmpInfo.bmiHeader.biWidth = width;
+   bmpInfo.bmiHeader.biHeight = -height;
+   bmpInfo.bmiHeader.biPlanes = 1;
+   bmpInfo.bmiHeader.biBitCount = 32;
+   bmpInfo.bmiHeader.biCompression = BI_RGB;
+
+   // Fails for large sizes (an 8K target is 127 MB) when memory is short.
+   m_bitmap = ::CreateDIBSection(m_bitmapDC, &bmpInfo, DIB_RGB_COLORS, &m_bitmapData, 0, 0);
+   if (!m_bitmap)
+      return;
+
+   m_oldBitmap = (HBITMAP)::SelectObject(m_bitmapDC, m_bitmap);
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+   if (m_bitmapDC)
+   {
+      if (m_oldBitmap)
+         ::SelectObject(m_bitmapDC, m_oldBitmap);
+      ::DeleteDC(m_bitmapDC);
+   }
+
+   if (m_bitmap)
+      ::DeleteObject(m_bitmap);
+
+   if (m_windowDC)
+      ::ReleaseDC(m_window, m_windowDC);
+
+   if (m_window)
+      ::DestroyWindow(m_window);
+}
+
+PixelBufferView OffscreenTarget::pixels() const
+{
+   // GDI may still be drawing into the DIB section.
+   ::GdiFlush();
+
+   // 32-bit rows need no padding.
+   return PixelBufferView(static_cast<unsigned char*>(m_bitmapData), m_width, m_height, m_width * 4,
+                          e_PixelFormatARGB32);
+}
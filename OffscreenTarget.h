@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include "PixelBufferView.h"
+
+#include <Windows.h>
+
+/**
+  A window that is never shown plus a 32-bit DIB section of the same size,
+  so the benchmark runner can drive the window-based renderers without
+  putting anything on screen.
+*/
+class OffscreenTarget
+{
+public:
+   OffscreenTarget(int width, int height);
+   ~OffscreenTarget();
+
+   bool isValid() const { return m_window && m_windowDC && m_bitmapDC && m_bitmap && m_bitmapData; }
+
+   int width() const { return m_width; }
+   int height() const { return m_height; }
+
+   HWND window() const { return m_window; }
+
+   // Device context of the hidden window, for the GL and Direct2D renderers.
+   HDC windowDC() const { return m_windowDC; }
+
+   // Memory device context with the DIB section selected, for the GDI backed renderers.
+   HDC bitmapDC() const { return m_bitmapDC; }
+   void* bitmapData() const { return m_bitmapData; }
+
+   // The DIB section's pixels, top-down.
+   PixelBufferView pixels() const;
+
+private:
+   int m_width;
+   int m_height;
+   HWND m_window;
+   HDC m_windowDC;
+   HDC m_bitmapDC;
+   HBITMAP m_bitmap;
+   HBITMAP m_oldBitmap;
+   void* m_bitmapData;
+};
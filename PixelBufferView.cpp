@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "PixelBufferView.h"
+
+#include <cairo/cairo.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+PixelBufferView::PixelBufferView()
+   : m_data(0), m_width(0), m_height(0), m_stride(0), m_format(e_PixelFormatInvalid)
+{
+}
+
+PixelBufferView::PixelBufferView(unsigned char* data, int width, int height, ptrdiff_t stride, PixelFormat format)
+   : m_data(data), m_width(width), m_height(height), m_stride(stride), m_format(format)
+{
+   // Rows closer together than a row's worth of pixels would overlap.
+   const ptrdiff_t rowBytes = static_cast<ptrdiff_t>(width) * BytesPerPixel(format);
+   if (!data || width <= 0 || height <= 0 || format == e_PixelFormatInvalid
+       || (stride < 0 ? -stride : stride) < rowBytes)
+      *this = PixelBufferView();
+}
+
+PixelBufferView PixelBufferView::fromCairoImageSurface(cairo_surface_t* surface)
+{
+   if (!surface || cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE)
+      return PixelBufferView();
+
+   PixelFormat format;
+   switch (cairo_image_surface_get_format(surface))
+   {
+   case CAIRO_FORMAT_ARGB32:
+      format = e_PixelFormatARGB32;
+      break;
+   case CAIRO_FORMAT_RGB24:
+      format = e_PixelFormatRGB24;
+      break;
+   case CAIRO_FORMAT_RGB16_565:
+      format = e_PixelFormatRGB16_565;
+      break;
+   case CAIRO_FORMAT_A8:
+      format = e_PixelFormatA8;
+      break;
+   default:
+      return PixelBufferView();
+   }
+
+   cairo_surface_flush(surface);
+   return PixelBufferView(cairo_image_surface_get_data(surface), cairo_image_surface_get_width(surface),
+                          cairo_image_surface_get_height(surface), cairo_image_surface_get_stride(surface), format);
+}
+
+int PixelBufferView::BytesPerPixel(PixelFormat format)
+{
+   switch (format)
+   {
+   case e_PixelFormatARGB32:
+   case e_PixelFormatRGB24:
+      return 4;
+   case e_PixelFormatRGB16_565:
+      return 2;
+   case e_PixelFormatA8:
+      return 1;
+   default:
+      return 0;
+   }
+}
+
+size_t PixelBufferView::BytesSpanned(int width, int height, ptrdiff_t stride, PixelFormat format)
+{
+   if (width <= 0 || height <= 0)
+      return 0;
+
+   return static_cast<size_t>(stride < 0 ? -stride : stride) * (height - 1) + static_cast<size_t>(width) * BytesPerPixel(format);
+}
+
+PixelRect PixelBufferView::bounds() const
+{
+   PixelRect rect = { 0, 0, m_width, m_height };
+   return rect;
+}
+
+PixelBufferView PixelBufferView::subView(const PixelRect& rect) const
+{
+   const PixelRect area = IntersectPixelRects(rect, bounds());
+   if (area.isEmpty())
+      return PixelBufferView();
+
+   return PixelBufferView(pixel(area.left, area.top), area.width(), area.height(), m_stride, m_format);
+}
+
+MappedPixelFile::MappedPixelFile()
+   : m_data(0), m_size(0)
+#if defined(_WIN32)
+   , m_file(INVALID_HANDLE_VALUE), m_mapping(0)
+#endif
+{
+}
+
+MappedPixelFile::~MappedPixelFile()
+{
+   close();
+}
+
+bool MappedPixelFile::open(const char* path, bool writable)
+{
+   close();
+
+#if defined(_WIN32)
+   m_file = ::CreateFileA(path, GENERIC_READ | (writable ? GENERIC_WRITE : 0), FILE_SHARE_READ, 0, OPEN_EXISTING,
+                          FILE_ATTRIBUTE_NORMAL, 0);
+   if (m_file == INVALID_HANDLE_VALUE)
+      return false;
+
+   LARGE_INTEGER size;
+   if (!::GetFileSizeEx(m_file, &size) || !size.QuadPart || static_cast<unsigned long long>(size.QuadPart) > static_cast<size_t>(-1))
+   {
+      close();
+      return false;
+   }
+
+   m_mapping = ::CreateFileMappingA(m_file, 0, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, 0);
+   if (m_mapping)
+      m_data = static_cast<unsigned char*>(::MapViewOfFile(m_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+
+   if (!m_data)
+   {
+      close();
+      return false;
+   }
+
+   m_size = static_cast<size_t>(size.QuadPart);
+#else
+   int file = ::open(path, writable ? O_RDWR : O_RDONLY);
+   if (file < 0)
+      return false;
+
+   struct stat status;
+   if (fstat(file, &status) || !status.st_size)
+   {
+      ::close(file);
+      return false;
+   }
+
+   // The mapping stays valid after the descriptor is closed.
+   void* data = mmap(0, static_cast<size_t>(status.st_size), PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, file, 0);
+   ::close(file);
+   if (data == MAP_FAILED)
+      return false;
+
+   m_data = static_cast<unsigned char*>(data);
+   m_size = static_cast<size_t>(status.st_size);
+#endif
+
+   return true;
+}
+
+void MappedPixelFile::close()
+{
+#if defined(_WIN32)
+   if (m_data)
+      ::UnmapViewOfFile(m_data);
+   if (m_mapping)
+      ::CloseHandle(m_mapping);
+   if (m_file != INVALID_HANDLE_VALUE)
+      ::CloseHandle(m_file);
+
+   m_mapping = 0;
+   m_file = INVALID_HANDLE_VALUE;
+#else
+   if (m_data)
+      munmap(m_data, m_size);
+#endif
+
+   m_data = 0;
+   m_size = 0;
+}
+
+PixelBufferView MappedPixelFile::pixels(size_t offset, int width, int height, ptrdiff_t stride, PixelFormat format) const
+{
+   const size_t bytes = PixelBufferView::BytesSpanned(width, height, stride, format);
+   if (!m_data || !bytes || offset > m_size || bytes > m_size - offset)
+      return PixelBufferView();
+
+   // A negative stride starts from the last row in the file.
+   unsigned char* first = m_data + offset;
+   if (stride < 0)
+      first += static_cast<size_t>(-stride) * (height - 1);
+
+   return PixelBufferView(first, width, height, stride, format);
+}
+
+static bool HasWordPixels(const PixelBufferView& view)
+{
+   return view.isValid() && view.bytesPerPixel() == 4;
+}
+
+void SetPixelAlpha(const PixelBufferView& view, unsigned char alpha, const PixelKernels& kernels)
+{
+   if (HasWordPixels(view))
+      SetPixelAlpha(view.data(), view.stride(), view.width(), view.height(), view.bounds(), alpha, kernels);
+}
+
+void FillPixels(const PixelBufferView& view, unsigned value, const PixelKernels& kernels)
+{
+   if (HasWordPixels(view))
+      FillPixels(view.data(), view.stride(), view.width(), view.height(), view.bounds(), value, kernels);
+}
+
+// Only ARGB32 has an alpha byte to scale by; in RGB24 it is padding.
+static bool HasAlphaPixels(const PixelBufferView& view)
+{
+   return view.isValid() && view.format() == e_PixelFormatARGB32;
+}
+
+void PremultiplyPixels(const PixelBufferView& view, const PixelKernels& kernels)
+{
+   if (HasAlphaPixels(view))
+      PremultiplyPixels(view.data(), view.stride(), view.width(), view.height(), view.bounds(), kernels);
+}
+
+void UnpremultiplyPixels(const PixelBufferView& view, const PixelKernels& kernels)
+{
+   if (HasAlphaPixels(view))
+      UnpremultiplyPixels(view.data(), view.stride(), view.width(), view.height(), view.bounds(), kernels);
+}
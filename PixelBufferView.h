@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include "PixelOps.h"
+
+#include <cstddef>
+
+typedef struct _cairo_surface cairo_surface_t;
+
+enum PixelFormat
+{
+   e_PixelFormatInvalid,
+   e_PixelFormatARGB32,   // premultiplied, alpha in the high byte of each 32-bit pixel
+   e_PixelFormatRGB24,    // 32 bits per pixel, the high byte unused
+   e_PixelFormatRGB16_565,// 16 bits per pixel, red in the top 5 bits
+   e_PixelFormatA8        // alpha only
+};
+
+/**
+  A strided view of pixels owned by someone else: a cairo image surface, a
+  DIB section, a block of memory or a mapped file. Nothing is copied, so
+  the owner must outlive the view and cairo surfaces must be flushed before
+  and marked dirty after writing through it. The stride may be negative for
+  bottom-up images, so row 0 is always the top row, but its magnitude must
+  cover a row of pixels.
+*/
+class PixelBufferView
+{
+public:
+   PixelBufferView();
+   PixelBufferView(unsigned char* data, int width, int height, ptrdiff_t stride, PixelFormat format);
+
+   /**
+     The pixels of an image surface, flushed first. Returns an empty view
+     for other surface types and formats without a PixelFormat.
+   */
+   static PixelBufferView fromCairoImageSurface(cairo_surface_t* surface);
+
+   bool isValid() const { return m_data != 0; }
+
+   unsigned char* data() const { return m_data; }
+   int width() const { return m_width; }
+   int height() const { return m_height; }
+   ptrdiff_t stride() const { return m_stride; }
+   PixelFormat format() const { return m_format; }
+
+   int bytesPerPixel() const { return BytesPerPixel(m_format); }
+   unsigned char* row(int y) const { return m_data + y * m_stride; }
+   unsigned char* pixel(int x, int y) const { return row(y) + x * bytesPerPixel(); }
+
+   /**
+     The part of rect inside this view, sharing its pixels.
+   */
+   PixelBufferView subView(const PixelRect& rect) const;
+
+   PixelRect bounds() const;
+
+   static int BytesPerPixel(PixelFormat format);
+
+   /**
+     Bytes a width x height image with rows stride bytes apart spans.
+   */
+   static size_t BytesSpanned(int width, int height, ptrdiff_t stride, PixelFormat format);
+
+private:
+   unsigned char* m_data;
+   int m_width;
+   int m_height;
+   ptrdiff_t m_stride;
+   PixelFormat m_format;
+};
+
+/**
+  A file mapped into memory, to view raw pixels stored in it (a frame dump,
+  a capture written by another process) without reading them in.
+*/
+class MappedPixelFile
+{
+public:
+   MappedPixelFile();
+   ~MappedPixelFile();
+
+   bool open(const char* path, bool writable = false);
+   void close();
+
+   bool isOpen() const { return m_data != 0; }
+   size_t size() const { return m_size; }
+
+   /**
+     A view of the pixels starting offset bytes into the file, or an empty
+     view if they would run past its end.
+   */
+   PixelBufferView pixels(size_t offset, int width, int height, ptrdiff_t stride, PixelFormat format) const;
+
+private:
+   MappedPixelFile(const MappedPixelFile&);
+   MappedPixelFile& operator=(const MappedPixelFile&);
+
+   unsigned char* m_data;
+   size_t m_size;
+#if defined(_WIN32)
+   void* m_file;
+   void* m_mapping;
+#endif
+};
+
+// The PixelOps kernels over a whole view of 32-bit pixels; premultiplying
+// and unpremultiplying only apply to ARGB32.
+void SetPixelAlpha(const PixelBufferView& view, unsigned char alpha, const PixelKernels& kernels = BestPixelKernels());
+void FillPixels(const PixelBufferView& view, unsigned value, const PixelKernels& kernels = BestPixelKernels());
+void PremultiplyPixels(const PixelBufferView& view, const PixelKernels& kernels = BestPixelKernels());
+void UnpremultiplyPixels(const PixelBufferView& view, const PixelKernels& kernels = BestPixelKernels());
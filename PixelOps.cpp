@@ -0,0 +1,484 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "PixelOps.h"
+
+#include <algorithm>
+
+#undef min
+#undef max
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define PIXEL_OPS_X86 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+// AVX2 intrinsics need Visual C++ 2012 or GCC/Clang with target attributes.
+#if (defined(_MSC_VER) && _MSC_VER >= 1700) || (!defined(_MSC_VER) && defined(__GNUC__))
+#define PIXEL_OPS_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+// GCC and Clang only allow intrinsics of extensions enabled for the function.
+#if defined(__GNUC__)
+#define SSE2_FUNCTION __attribute__((target("sse2")))
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define SSE2_FUNCTION
+#define AVX2_FUNCTION
+#endif
+
+PixelRect IntersectPixelRects(const PixelRect& a, const PixelRect& b)
+{
+   PixelRect result;
+   result.left = std::max(a.left, b.left);
+   result.top = std::max(a.top, b.top);
+   result.right = std::min(a.right, b.right);
+   result.bottom = std::min(a.bottom, b.bottom);
+
+   if (result.isEmpty())
+   {
+      PixelRect empty = { 0, 0, 0, 0 };
+      return empty;
+   }
+
+   return result;
+}
+
+// Scalar kernels, also used for the pixels left over by the vector loops.
+
+struct UnpremultiplyTable
+{
+   UnpremultiplyTable()
+   {
+      factors[0] = 0.0f;
+      for (int a = 1; a < 256; ++a)
+         factors[a] = 255.0f / a;
+   }
+
+   float factors[256];
+};
+
+static const UnpremultiplyTable unpremultiplyTable;
+
+static void ScalarSetAlpha(unsigned* pixels, size_t count, unsigned char alpha)
+{
+   const unsigned a = static_cast<unsigned>(alpha) << 24;
+   for (size_t i = 0; i < count; ++i)
+      pixels[i] = (pixels[i] & 0x00ffffff) | a;
+}
+
+static void ScalarFill(unsigned* pixels, size_t count, unsigned value)
+{
+   for (size_t i = 0; i < count; ++i)
+      pixels[i] = value;
+}
+
+static inline unsigned MultiplyChannel(unsigned c, unsigned a)
+{
+   // c * a / 255 rounded, without a division.
+   const unsigned t = c * a + 128;
+   return (t + (t >> 8)) >> 8;
+}
+
+static void ScalarPremultiply(unsigned* pixels, size_t count)
+{
+   for (size_t i = 0; i < count; ++i)
+   {
+      const unsigned p = pixels[i];
+      const unsigned a = p >> 24;
+      pixels[i] = (a << 24) | (MultiplyChannel((p >> 16) & 0xff, a) << 16)
+                | (MultiplyChannel((p >> 8) & 0xff, a) << 8) | MultiplyChannel(p & 0xff, a);
+   }
+}
+
+static inline unsigned DivideChannel(unsigned c, float factor)
+{
+   // Each step is rounded to single precision, as in the vector kernels.
+   float scaled = static_cast<float>(static_cast<int>(c)) * factor;
+   scaled = scaled + 0.5f;
+   const unsigned v = static_cast<unsigned>(static_cast<int>(scaled));
+   return v > 255 ? 255 : v;
+}
+
+static void ScalarUnpremultiply(unsigned* pixels, size_t count)
+{
+   for (size_t i = 0; i < count; ++i)
+   {
+      const unsigned p = pixels[i];
+      const unsigned a = p >> 24;
+      const float factor = unpremultiplyTable.factors[a];
+      pixels[i] = (a << 24) | (DivideChannel((p >> 16) & 0xff, factor) << 16)
+                | (DivideChannel((p >> 8) & 0xff, factor) << 8) | DivideChannel(p & 0xff, factor);
+   }
+}
+
+static const PixelKernels scalarKernels =
+{
+   "scalar", ScalarSetAlpha, ScalarFill, ScalarPremultiply, ScalarUnpremultiply
+};
+
+#if defined(PIXEL_OPS_X86)
+
+SSE2_FUNCTION static void SSE2SetAlpha(unsigned* pixels, size_t count, unsigned char alpha)
+{
+   const __m128i colour = _mm_set1_epi32(0x00ffffff);
+   const __m128i a = _mm_set1_epi32(static_cast<int>(static_cast<unsigned>(alpha) << 24));
+
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128i* p = reinterpret_cast<__m128i*>(pixels + i);
+      _mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(p), colour), a));
+   }
+
+   ScalarSetAlpha(pixels + i, count - i, alpha);
+}
+
+SSE2_FUNCTION static void SSE2Fill(unsigned* pixels, size_t count, unsigned value)
+{
+   const __m128i v = _mm_set1_epi32(static_cast<int>(value));
+
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4)
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), v);
+
+   ScalarFill(pixels + i, count - i, value);
+}
+
+/**
+  MultiplyChannel on two pixels widened to 16 bits per channel. The alpha
+  channel is multiplied by 255, which leaves it unchanged.
+*/
+SSE2_FUNCTION static inline __m128i SSE2MultiplyChannels(__m128i pixels)
+{
+   const __m128i colourLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+   const __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+   const __m128i round = _mm_set1_epi16(128);
+
+   __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+   a = _mm_or_si128(_mm_and_si128(a, colourLanes), alphaLanes);
+
+   const __m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels, a), round);
+   return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+SSE2_FUNCTION static void SSE2Premultiply(unsigned* pixels, size_t count)
+{
+   const __m128i zero = _mm_setzero_si128();
+
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128i* p = reinterpret_cast<__m128i*>(pixels + i);
+      const __m128i v = _mm_loadu_si128(p);
+      const __m128i low = SSE2MultiplyChannels(_mm_unpacklo_epi8(v, zero));
+      const __m128i high = SSE2MultiplyChannels(_mm_unpackhi_epi8(v, zero));
+      _mm_storeu_si128(p, _mm_packus_epi16(low, high));
+   }
+
+   ScalarPremultiply(pixels + i, count - i);
+}
+
+/**
+  DivideChannel on one pixel widened to 32 bits per channel; the alpha
+  channel is scaled by 1.
+*/
+SSE2_FUNCTION static inline __m128i SSE2DivideChannels(__m128i pixel, unsigned alpha)
+{
+   const float f = unpremultiplyTable.factors[alpha];
+   const __m128 scaled = _mm_mul_ps(_mm_cvtepi32_ps(pixel), _mm_set_ps(1.0f, f, f, f));
+   return _mm_cvttps_epi32(_mm_add_ps(scaled, _mm_set1_ps(0.5f)));
+}
+
+SSE2_FUNCTION static void SSE2Unpremultiply(unsigned* pixels, size_t count)
+{
+   const __m128i zero = _mm_setzero_si128();
+
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128i* p = reinterpret_cast<__m128i*>(pixels + i);
+      const __m128i v = _mm_loadu_si128(p);
+      const __m128i low = _mm_unpacklo_epi8(v, zero);
+      const __m128i high = _mm_unpackhi_epi8(v, zero);
+
+      const __m128i p0 = SSE2DivideChannels(_mm_unpacklo_epi16(low, zero), pixels[i] >> 24);
+      const __m128i p1 = SSE2DivideChannels(_mm_unpackhi_epi16(low, zero), pixels[i + 1] >> 24);
+      const __m128i p2 = SSE2DivideChannels(_mm_unpacklo_epi16(high, zero), pixels[i + 2] >> 24);
+      const __m128i p3 = SSE2DivideChannels(_mm_unpackhi_epi16(high, zero), pixels[i + 3] >> 24);
+
+      // Saturating packs clamp the channels to 255.
+      _mm_storeu_si128(p, _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3)));
+   }
+
+   ScalarUnpremultiply(pixels + i, count - i);
+}
+
+static const PixelKernels sse2Kernels =
+{
+   "sse2", SSE2SetAlpha, SSE2Fill, SSE2Premultiply, SSE2Unpremultiply
+};
+
+#endif // PIXEL_OPS_X86
+
+#if defined(PIXEL_OPS_AVX2)
+
+AVX2_FUNCTION static void AVX2SetAlpha(unsigned* pixels, size_t count, unsigned char alpha)
+{
+   const __m256i colour = _mm256_set1_epi32(0x00ffffff);
+   const __m256i a = _mm256_set1_epi32(static_cast<int>(static_cast<unsigned>(alpha) << 24));
+
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      __m256i* p = reinterpret_cast<__m256i*>(pixels + i);
+      _mm256_storeu_si256(p, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(p), colour), a));
+   }
+
+   ScalarSetAlpha(pixels + i, count - i, alpha);
+}
+
+AVX2_FUNCTION static void AVX2Fill(unsigned* pixels, size_t count, unsigned value)
+{
+   const __m256i v = _mm256_set1_epi32(static_cast<int>(value));
+
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8)
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + i), v);
+
+   ScalarFill(pixels + i, count - i, value);
+}
+
+AVX2_FUNCTION static inline __m256i AVX2MultiplyChannels(__m256i pixels)
+{
+   const __m256i colourLanes = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+   const __m256i alphaLanes = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+   const __m256i round = _mm256_set1_epi16(128);
+
+   __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+   a = _mm256_or_si256(_mm256_and_si256(a, colourLanes), alphaLanes);
+
+   const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(pixels, a), round);
+   return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+AVX2_FUNCTION static void AVX2Premultiply(unsigned* pixels, size_t count)
+{
+   const __m256i zero = _mm256_setzero_si256();
+
+   // Unpacking and packing both work within 128-bit lanes, so the pixels
+   // come back in their original order.
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      __m256i* p = reinterpret_cast<__m256i*>(pixels + i);
+      const __m256i v = _mm256_loadu_si256(p);
+      const __m256i low = AVX2MultiplyChannels(_mm256_unpacklo_epi8(v, zero));
+      const __m256i high = AVX2MultiplyChannels(_mm256_unpackhi_epi8(v, zero));
+      _mm256_storeu_si256(p, _mm256_packus_epi16(low, high));
+   }
+
+   ScalarPremultiply(pixels + i, count - i);
+}
+
+/**
+  DivideChannel on the two pixels at pixels, widened to 32 bits per channel.
+*/
+AVX2_FUNCTION static inline __m256i AVX2DivideChannels(const unsigned* pixels)
+{
+   const float f0 = unpremultiplyTable.factors[pixels[0] >> 24];
+   const float f1 = unpremultiplyTable.factors[pixels[1] >> 24];
+
+   const __m256i wide = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels)));
+   const __m256 scaled = _mm256_mul_ps(_mm256_cvtepi32_ps(wide), _mm256_set_ps(1.0f, f1, f1, f1, 1.0f, f0, f0, f0));
+   return _mm256_cvttps_epi32(_mm256_add_ps(scaled, _mm256_set1_ps(0.5f)));
+}
+
+AVX2_FUNCTION static void AVX2Unpremultiply(unsigned* pixels, size_t count)
+{
+   // The lane-wise packs leave the pixels in the order 0 2 4 6 1 3 5 7.
+   const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      const __m256i p01 = AVX2DivideChannels(pixels + i);
+      const __m256i p23 = AVX2DivideChannels(pixels + i + 2);
+      const __m256i p45 = AVX2DivideChannels(pixels + i + 4);
+      const __m256i p67 = AVX2DivideChannels(pixels + i + 6);
+
+      const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(p01, p23), _mm256_packs_epi32(p45, p67));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + i), _mm256_permutevar8x32_epi32(packed, order));
+   }
+
+   ScalarUnpremultiply(pixels + i, count - i);
+}
+
+static const PixelKernels avx2Kernels =
+{
+   "avx2", AVX2SetAlpha, AVX2Fill, AVX2Premultiply, AVX2Unpremultiply
+};
+
+#endif // PIXEL_OPS_AVX2
+
+#if defined(PIXEL_OPS_X86)
+
+static bool ProcessorHasSSE2()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+   return true;
+#elif defined(_MSC_VER)
+   int info[4];
+   __cpuid(info, 1);
+   return (info[3] & (1 << 26)) != 0;
+#else
+   return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+
+static bool ProcessorHasAVX2()
+{
+#if defined(_MSC_VER)
+   int info[4];
+   __cpuid(info, 0);
+   if (info[0] < 7)
+      return false;
+
+   // The OS must also save the YMM registers on context switches.
+   __cpuid(info, 1);
+   const int osxsaveAndAVX = (1 << 27) | (1 << 28);
+   if ((info[2] & osxsaveAndAVX) != osxsaveAndAVX || (_xgetbv(0) & 6) != 6)
+      return false;
+
+   __cpuidex(info, 7, 0);
+   return (info[1] & (1 << 5)) != 0;
+#else
+   return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // PIXEL_OPS_X86
+
+const PixelKernels* PixelKernelsFor(PixelInstructionSet set)
+{
+   switch (set)
+   {
+   case e_PixelScalar:
+      return &scalarKernels;
+#if defined(PIXEL_OPS_X86)
+   case e_PixelSSE2:
+      return ProcessorHasSSE2() ? &sse2Kernels : 0;
+#endif
+#if defined(PIXEL_OPS_AVX2)
+   case e_PixelAVX2:
+      return ProcessorHasAVX2() ? &avx2Kernels : 0;
+#endif
+   default:
+      return 0;
+   }
+}
+
+const PixelKernels& BestPixelKernels()
+{
+   static const PixelKernels* best = 0;
+
+   // Racing threads all arrive at the same answer.
+   if (!best)
+   {
+      const PixelKernels* kernels = &scalarKernels;
+      for (int set = e_PixelScalar + 1; set < e_PixelInstructionSetCount; ++set)
+      {
+         if (const PixelKernels* candidate = PixelKernelsFor(static_cast<PixelInstructionSet>(set)))
+            kernels = candidate;
+      }
+      best = kernels;
+   }
+
+   return *best;
+}
+
+/**
+  Calls kernel on each row of the part of rect inside the buffer.
+*/
+template <typename RowKernel>
+static void ForEachRow(unsigned char* pixels, ptrdiff_t stride, int width, int height, const PixelRect& rect,
+                       RowKernel kernel)
+{
+   const PixelRect bounds = { 0, 0, width, height };
+   const PixelRect area = IntersectPixelRects(rect, bounds);
+   if (area.isEmpty())
+      return;
+
+   unsigned char* row = pixels + area.top * stride + area.left * 4;
+   for (int y = area.top; y < area.bottom; ++y, row += stride)
+      kernel(reinterpret_cast<unsigned*>(row), static_cast<size_t>(area.width()));
+}
+
+struct SetAlphaRow
+{
+   SetAlphaRow(const PixelKernels& kernels, unsigned char alpha) : kernels(kernels), alpha(alpha) {}
+   void operator()(unsigned* row, size_t count) const { kernels.setAlpha(row, count, alpha); }
+
+   const PixelKernels& kernels;
+   unsigned char alpha;
+};
+
+struct FillRow
+{
+   FillRow(const PixelKernels& kernels, unsigned value) : kernels(kernels), value(value) {}
+   void operator()(unsigned* row, size_t count) const { kernels.fill(row, count, value); }
+
+   const PixelKernels& kernels;
+   unsigned value;
+};
+
+void SetPixelAlpha(unsigned char* pixels, ptrdiff_t stride, int width, int height, const PixelRect& rect,
+                   unsigned char alpha, const PixelKernels& kernels)
+{
+   ForEachRow(pixels, stride, width, height, rect, SetAlphaRow(kernels, alpha));
+}
+
+void FillPixels(unsigned char* pixels, ptrdiff_t stride, int width, int height, const PixelRect& rect,
+                unsigned value, const PixelKernels& kernels)
+{
+   ForEachRow(pixels, stride, width, height, rect, FillRow(kernels, value));
+}
+
+void PremultiplyPixels(unsigned char* pixels, ptrdiff_t stride, int width, int height, const PixelRect& rect,
+                       const PixelKernels& kernels)
+{
+   ForEachRow(pixels, stride, width, height, rect, kernels.premultiply);
+}
+
+void UnpremultiplyPixels(unsigned char* pixels, ptrdiff_t stride, int width, int height, const PixelRect& rect,
+                         const PixelKernels& kernels)
+{
+   ForEachRow(pixels, stride, width, height, rect, kernels.unpremultiply);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include <cstddef>
+
+/**
+  Rectangle of pixels, right and bottom exclusive.
+*/
+struct PixelRect
+{
+   int left;
+   int top;
+   int right;
+   int bottom;
+
+   int width() const { return right - left; }
+   int height() const { return bottom - top; }
+   bool isEmpty() const { return right <= left || bottom <= top; }
+};
+
+/**
+  The overlap of a and b, or an empty rectangle at the origin if they do not
+  overlap.
+*/
+PixelRect IntersectPixelRects(const PixelRect& a, const PixelRect& b);
+
+/**
+  Row kernels over 32-bit pixels with alpha in the high byte (BGRA in
+  memory, as in RGBQUAD, DIB sections and CAIRO_FORMAT_ARGB32 on little
+  endian machines). Every instruction set produces exactly the same pixels.
+
+  Premultiplying rounds c * a / 255 to nearest. Unpremultiplying computes
+  c * (255 / a) in single precision, rounds and clamps to 255, and turns
+  pixels with zero alpha into transparent black.
+*/
+struct PixelKernels
+{
+   const char* name;
+   void (*setAlpha)(unsigned* pixels, size_t count, unsigned char alpha);
+   void (*fill)(unsigned* pixels, size_t count, unsigned value);
+   void (*premultiply)(unsigned* pixels, size_t count);
+   void (*unpremultiply)(unsigned* pixels, size_t count);
+};
+
+enum PixelInstructionSet
+{
+   e_PixelScalar,
+   e_PixelSSE2,
+   e_PixelAVX2,
+   e_PixelInstructionSetCount
+};
+
+/**
+  The kernels for an instruction set, or 0 if they were not compiled in or
+  the processor lacks it.
+*/
+const PixelKernels* PixelKernelsFor(PixelInstructionSet set);
+
+// The fastest kernels this processor can run.
+const PixelKernels& BestPixelKernels();
+
+// Apply the kernels to the part of rect inside a width x height buffer
+// whose rows are stride bytes apart.
+void SetPixelAlpha(unsigned char* pixels, ptrdiff_t stride, int width, int height, const PixelRect& rect,
+                   unsigned char alpha, const PixelKernels& kernels = BestPixelKernels());
+void FillPixels(unsigned char* pixels, ptrdiff_t stride, int width, int height, const PixelRect& rect,
+                unsigned value, const PixelKernels& kernels = BestPixelKernels());
+void PremultiplyPixels(unsigned char* pixels, ptrdiff_t stride, int width, int height, const PixelRect& rect,
+                       const PixelKernels& kernels = BestPixelKernels());
+void UnpremultiplyPixels(unsigned char* pixels, ptrdiff_t stride, int width, int height, const PixelRect& rect,
+                         const PixelKernels& kernels = BestPixelKernels());
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "RenderZones.h"
+
+#include "Timing.h"
+
+#include <algorithm>
+
+#undef min
+#undef max
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+static THREAD_LOCAL RenderPhaseStatistics* currentStatistics = 0;
+
+static const char* phaseNames[e_PhaseCount] =
+{
+   "background",
+   "face",
+   "ticks",
+   "hands",
+   "text",
+   "flush"
+};
+
+RenderPhaseStatistics::RenderPhaseStatistics()
+{
+   reset();
+}
+
+RenderPhaseStatistics* RenderPhaseStatistics::current()
+{
+   return currentStatistics;
+}
+
+void RenderPhaseStatistics::setCurrent(RenderPhaseStatistics* statistics)
+{
+   currentStatistics = statistics;
+}
+
+void RenderPhaseStatistics::reset()
+{
+   m_frameStart = 0.0;
+   m_totalFrameTime = 0.0;
+   m_frames = 0;
+
+   for (int i = 0; i < e_PhaseCount; ++i)
+   {
+      m_frameTimes[i] = 0.0;
+      m_totalTimes[i] = 0.0;
+      m_maximumTimes[i] = 0.0;
+   }
+}
+
+void RenderPhaseStatistics::beginFrame()
+{
+   for (int i = 0; i < e_PhaseCount; ++i)
+      m_frameTimes[i] = 0.0;
+
+   m_frameStart = MonotonicTime();
+}
+
+void RenderPhaseStatistics::endFrame()
+{
+   m_totalFrameTime += MonotonicTime() - m_frameStart;
+
+   for (int i = 0; i < e_PhaseCount; ++i)
+   {
+      m_totalTimes[i] += m_frameTimes[i];
+      m_maximumTimes[i] = std::max(m_maximumTimes[i], m_frameTimes[i]);
+   }
+
+   ++m_frames;
+}
+
+void RenderPhaseStatistics::addTime(RenderPhase phase, double seconds)
+{
+   // A phase may be entered more than once per frame (one zone per clock, say).
+   m_frameTimes[phase] += seconds;
+}
+
+void RenderPhaseStatistics::writeTable(FILE* out) const
+{
+   if (!m_frames)
+      return;
+
+   const double ms = 1000.0;
+   double trackedTime = 0.0;
+
+   fprintf(out, "%-12s %10s %10s %7s\n", "phase", "mean ms", "max ms", "share");
+   for (int i = 0; i < e_PhaseCount; ++i)
+   {
+      trackedTime += m_totalTimes[i];
+      fprintf(out, "%-12s %10.4f %10.4f %6.1f%%\n", phaseNames[i],
+              m_totalTimes[i] / m_frames * ms, m_maximumTimes[i] * ms,
+              m_totalFrameTime > 0.0 ? 100.0 * m_totalTimes[i] / m_totalFrameTime : 0.0);
+   }
+
+   double untracked = std::max(0.0, m_totalFrameTime - trackedTime);
+   fprintf(out, "%-12s %10.4f %10s %6.1f%%\n", "(other)", untracked / m_frames * ms, "",
+           m_totalFrameTime > 0.0 ? 100.0 * untracked / m_totalFrameTime : 0.0);
+}
+
+ScopedRenderZone::ScopedRenderZone(RenderPhase phase)
+   : m_statistics(currentStatistics), m_phase(phase), m_start(0.0)
+{
+   if (m_statistics)
+      m_start = MonotonicTime();
+}
+
+ScopedRenderZone::~ScopedRenderZone()
+{
+   if (m_statistics)
+      m_statistics->addTime(m_phase, MonotonicTime() - m_start);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#include <cstdio>
+
+/**
+  Drawing phases shared by every RenderDemo implementation.
+*/
+enum RenderPhase
+{
+   e_PhaseBackground,
+   e_PhaseFace,
+   e_PhaseTicks,
+   e_PhaseHands,
+   e_PhaseText,
+   e_PhaseFlush,
+   e_PhaseCount
+};
+
+/**
+  Collects the time spent in each RenderPhase, frame by frame. Zones only
+  record into the collector installed for the calling thread, so a renderer
+  costs nothing extra unless somebody asked for the breakdown.
+*/
+class RenderPhaseStatistics
+{
+public:
+   RenderPhaseStatistics();
+
+   static RenderPhaseStatistics* current();
+   static void setCurrent(RenderPhaseStatistics*);
+
+   void beginFrame();
+   void endFrame();
+   void addTime(RenderPhase, double seconds);
+   void reset();
+
+   unsigned frames() const { return m_frames; }
+
+   /**
+     Prints mean and worst time per frame for each phase, plus the time spent
+     in RenderDemo outside of any zone.
+   */
+   void writeTable(FILE*) const;
+
+private:
+   double m_frameStart;
+   double m_frameTimes[e_PhaseCount];
+   double m_totalTimes[e_PhaseCount];
+   double m_maximumTimes[e_PhaseCount];
+   double m_totalFrameTime;
+   unsigned m_frames;
+};
+
+class ScopedRenderZone
+{
+public:
+   explicit ScopedRenderZone(RenderPhase);
+   ~ScopedRenderZone();
+
+private:
+   RenderPhaseStatistics* m_statistics;
+   RenderPhase m_phase;
+   double m_start;
+};
+
+// Define NO_RENDER_ZONES to compile the instrumentation out entirely.
+#if defined(NO_RENDER_ZONES)
+#define RENDER_ZONE(phase)
+#else
+#define RENDER_ZONE(phase) ScopedRenderZone renderZone(phase)
+#endif
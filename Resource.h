@@ -17,6 +17,11 @@
 #define IDM_CG                  111
 #define IDM_D2D                 112
 #define IDM_CAIRO_GL            113
+#define IDM_PACE_UNCAPPED       114
+#define IDM_PACE_60HZ           115
+#define IDM_PACE_120HZ          116
+#define IDM_PACE_240HZ          117
+#define IDM_PACE_ON_DEMAND      118
 #define IDC_MYICON				2
 #ifndef IDC_STATIC
 #define IDC_STATIC				-1
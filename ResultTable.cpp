@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "ResultTable.h"
+
+#include <algorithm>
+
+#undef min
+#undef max
+
+void ResultTable::addColumn(const char* name)
+{
+   m_columns.push_back(name);
+}
+
+void ResultTable::beginRow()
+{
+   m_rows.push_back(std::vector<std::string>());
+}
+
+void ResultTable::addCell(const std::string& text)
+{
+   m_rows.back().push_back(text);
+}
+
+void ResultTable::addCell(int value)
+{
+   char buffer[32];
+   snprintf(buffer, sizeof(buffer), "%d", value);
+   buffer[sizeof(buffer) - 1] = 0;
+   addCell(std::string(buffer));
+}
+
+void ResultTable::addCell(double value, const char* format)
+{
+   char buffer[64];
+   snprintf(buffer, sizeof(buffer), format, value);
+   buffer[sizeof(buffer) - 1] = 0;
+   addCell(std::string(buffer));
+}
+
+void ResultTable::write(FILE* out) const
+{
+   std::vector<size_t> widths(m_columns.size());
+   for (size_t column = 0; column < m_columns.size(); ++column)
+   {
+      widths[column] = m_columns[column].size() + (column ? 0 : 2);
+      for (size_t row = 0; row < m_rows.size(); ++row)
+      {
+         if (column < m_rows[row].size())
+            widths[column] = std::max(widths[column], m_rows[row][column].size());
+      }
+   }
+
+   // The first column is left aligned, numbers to its right are right aligned.
+   for (size_t column = 0; column < m_columns.size(); ++column)
+   {
+      if (!column)
+         fprintf(out, "# %-*s", static_cast<int>(widths[column] - 2), m_columns[column].c_str());
+      else
+         fprintf(out, "  %*s", static_cast<int>(widths[column]), m_columns[column].c_str());
+   }
+   fprintf(out, "\n");
+
+   for (size_t row = 0; row < m_rows.size(); ++row)
+   {
+      for (size_t column = 0; column < m_rows[row].size() && column < widths.size(); ++column)
+      {
+         if (!column)
+            fprintf(out, "%-*s", static_cast<int>(widths[column]), m_rows[row][column].c_str());
+         else
+            fprintf(out, "  %*s", static_cast<int>(widths[column]), m_rows[row][column].c_str());
+      }
+      fprintf(out, "\n");
+   }
+}
+
+void ResultTable::writeCSV(FILE* out) const
+{
+   for (size_t column = 0; column < m_columns.size(); ++column)
+      fprintf(out, "%s%s", column ? "," : "", m_columns[column].c_str());
+   fprintf(out, "\n");
+
+   for (size_t row = 0; row < m_rows.size(); ++row)
+   {
+      for (size_t column = 0; column < m_rows[row].size(); ++column)
+         fprintf(out, "%s%s", column ? "," : "", m_rows[row][column].c_str());
+      fprintf(out, "\n");
+   }
+}
+
+bool ResultTable::writeCSV(const std::string& path) const
+{
+   FILE* out = fopen(path.c_str(), "w");
+   if (!out)
+   {
+      fprintf(stderr, "could not open '%s' for writing\n", path.c_str());
+      return false;
+   }
+
+   writeCSV(out);
+   fclose(out);
+   return true;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "Timing.h"
+
+#if !defined(_WIN32)
+#include <time.h>
+#endif
+
+#if defined(_WIN32)
+static double FileTimeToSeconds(const FILETIME& fileTime)
+{
+   ULARGE_INTEGER ticks;
+   ticks.LowPart = fileTime.dwLowDateTime;
+   ticks.HighPart = fileTime.dwHighDateTime;
+
+   // FILETIME counts 100 nanosecond intervals.
+   return ticks.QuadPart * 1.0e-7;
+}
+
+double MonotonicTime()
+{
+   static double secondsPerCount = 0.0;
+   if (!secondsPerCount)
+   {
+      LARGE_INTEGER frequency;
+      ::QueryPerformanceFrequency(&frequency);
+      secondsPerCount = 1.0 / frequency.QuadPart;
+   }
+
+   LARGE_INTEGER counter;
+   ::QueryPerformanceCounter(&counter);
+   return counter.QuadPart * secondsPerCount;
+}
+
+double ProcessCPUTime()
+{
+   FILETIME creation, exit, kernel, user;
+   if (!::GetProcessTimes(::GetCurrentProcess(), &creation, &exit, &kernel, &user))
+      return 0.0;
+
+   return FileTimeToSeconds(kernel) + FileTimeToSeconds(user);
+}
+#else
+static double ClockSeconds(clockid_t clock)
+{
+   struct timespec now;
+   if (clock_gettime(clock, &now))
+      return 0.0;
+
+   return now.tv_sec + now.tv_nsec * 1.0e-9;
+}
+
+double MonotonicTime()
+{
+   return ClockSeconds(CLOCK_MONOTONIC);
+}
+
+double ProcessCPUTime()
+{
+   return ClockSeconds(CLOCK_PROCESS_CPUTIME_ID);
+}
+#endif
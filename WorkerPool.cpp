@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+
+#include "stdafx.h"
+
+#include "WorkerPool.h"
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+// Returns the value before the increment.
+static long FetchAndIncrement(volatile long* value)
+{
+#if defined(_WIN32)
+   return ::InterlockedIncrement(value) - 1;
+#else
+   return __sync_fetch_and_add(value, 1);
+#endif
+}
+
+WorkerPool::WorkerPool(unsigned threads)
+   : m_task(0), m_context(0), m_count(0), m_next(0), m_busy(0), m_generation(0), m_stopping(false)
+{
+#if defined(_WIN32)
+   ::InitializeCriticalSection(&m_mutex);
+   ::InitializeConditionVariable(&m_wake);
+   ::InitializeConditionVariable(&m_done);
+#else
+   pthread_mutex_init(&m_mutex, 0);
+   pthread_cond_init(&m_wake, 0);
+   pthread_cond_init(&m_done, 0);
+#endif
+
+   for (unsigned i = 1; i < threads; ++i)
+   {
+#if defined(_WIN32)
+      HANDLE thread = ::CreateThread(0, 0, workerMain, this, 0, 0);
+      if (!thread)
+         break;
+#else
+      pthread_t thread;
+      if (pthread_create(&thread, 0, workerMain, this))
+         break;
+#endif
+      m_workers.push_back(thread);
+   }
+}
+
+WorkerPool::~WorkerPool()
+{
+   lock();
+   m_stopping = true;
+#if defined(_WIN32)
+   ::WakeAllConditionVariable(&m_wake);
+#else
+   pthread_cond_broadcast(&m_wake);
+#endif
+   unlock();
+
+   for (size_t i = 0; i < m_workers.size(); ++i)
+   {
+#if defined(_WIN32)
+      ::WaitForSingleObject(m_workers[i], INFINITE);
+      ::CloseHandle(m_workers[i]);
+#else
+      pthread_join(m_workers[i], 0);
+#endif
+   }
+
+#if defined(_WIN32)
+   ::DeleteCriticalSection(&m_mutex);
+#else
+   pthread_cond_destroy(&m_done);
+   pthread_cond_destroy(&m_wake);
+   pthread_mutex_destroy(&m_mutex);
+#endif
+}
+
+unsigned WorkerPool::hardwareThreads()
+{
+#if defined(_WIN32)
+   SYSTEM_INFO info;
+   ::GetSystemInfo(&info);
+   return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+#else
+   long processors = sysconf(_SC_NPROCESSORS_ONLN);
+   return processors > 0 ? static_cast<unsigned>(processors) : 1;
+#endif
+}
+
+void WorkerPool::lock()
+{
+#if defined(_WIN32)
+   ::EnterCriticalSection(&m_mutex);
+#else
+   pthread_mutex_lock(&m_mutex);
+#endif
+}
+
+void WorkerPool::unlock()
+{
+#if defined(_WIN32)
+   ::LeaveCriticalSection(&m_mutex);
+#else
+   pthread_mutex_unlock(&m_mutex);
+#endif
+}
+
+void WorkerPool::run(Task task, void* context, unsigned count)
+{
+   if (!count)
+      return;
+
+   lock();
+   m_task = task;
+   m_context = context;
+   m_count = count;
+   m_next = 0;
+   m_busy = static_cast<unsigned>(m_workers.size());
+   ++m_generation;
+#if defined(_WIN32)
+   ::WakeAllConditionVariable(&m_wake);
+#else
+   pthread_cond_broadcast(&m_wake);
+#endif
+   unlock();
+
+   drain();
+
+   // Every worker has to check in, even if the batch ran out before it woke
+   // up, so that none of them still looks at this batch when run() returns.
+   lock();
+   while (m_busy)
+   {
+#if defined(_WIN32)
+      ::SleepConditionVariableCS(&m_done, &m_mutex, INFINITE);
+#else
+      pthread_cond_wait(&m_done, &m_mutex);
+#endif
+   }
+   unlock();
+}
+
+void WorkerPool::drain()
+{
+   for (;;)
+   {
+      long index = FetchAndIncrement(&m_next);
+      if (index >= static_cast<long>(m_count))
+         return;
+
+      m_task(m_context, static_cast<unsigned>(index));
+   }
+}
+
+void WorkerPool::workerLoop()
+{
+   unsigned seenGeneration = 0;
+
+   lock();
+   for (;;)
+   {
+      while (m_generation == seenGeneration && !m_stopping)
+      {
+#if defined(_WIN32)
+         ::SleepConditionVariableCS(&m_wake, &m_mutex, INFINITE);
+#else
+         pthread_cond_wait(&m_wake, &m_mutex);
+#endif
+      }
+
+      if (m_stopping)
+         break;
+
+      seenGeneration = m_generation;
+      unlock();
+
+      drain();
+
+      lock();
+      if (!--m_busy)
+      {
+#if defined(_WIN32)
+         ::WakeConditionVariable(&m_done);
+#else
+         pthread_cond_signal(&m_done);
+#endif
+      }
+   }
+   unlock();
+}
+
+#if defined(_WIN32)
+DWORD WINAPI WorkerPool::workerMain(void* pool)
+{
+   static_cast<WorkerPool*>(pool)->workerLoop();
+   return 0;
+}
+#else
+void* WorkerPool::workerMain(void* pool)
+{
+   static_cast<WorkerPool*>(pool)->workerLoop();
+   return 0;
+}
+#endif
+
+ThreadBarrier::ThreadBarrier(unsigned threads)
+   : m_waiting(threads)
+{
+#if defined(_WIN32)
+   ::InitializeCriticalSection(&m_mutex);
+   ::InitializeConditionVariable(&m_released);
+#else
+   pthread_mutex_init(&m_mutex, 0);
+   pthread_cond_init(&m_released, 0);
+#endif
+}
+
+ThreadBarrier::~ThreadBarrier()
+{
+#if defined(_WIN32)
+   ::DeleteCriticalSection(&m_mutex);
+#else
+   pthread_cond_destroy(&m_released);
+   pthread_mutex_destroy(&m_mutex);
+#endif
+}
+
+void ThreadBarrier::wait()
+{
+#if defined(_WIN32)
+   ::EnterCriticalSection(&m_mutex);
+   if (m_waiting && !--m_waiting)
+      ::WakeAllConditionVariable(&m_released);
+   while (m_waiting)
+      ::SleepConditionVariableCS(&m_released, &m_mutex, INFINITE);
+   ::LeaveCriticalSection(&m_mutex);
+#else
+   pthread_mutex_lock(&m_mutex);
+   if (m_waiting && !--m_waiting)
+      pthread_cond_broadcast(&m_released);
+   while (m_waiting)
+      pthread_cond_wait(&m_released, &m_mutex);
+   pthread_mutex_unlock(&m_mutex);
+#endif
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2012 Brent Fulgham.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE COMPUTER, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */
+#pragma once
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <vector>
+
+/**
+  A fixed set of threads that run batches of independent tasks.
+
+  run() hands out the indices 0..count-1 one at a time to whichever thread
+  is free, so uneven tasks balance themselves. The calling thread works on
+  the batch too, so a pool of n threads starts n - 1 workers, and a pool of
+  one thread simply runs everything in place.
+*/
+class WorkerPool
+{
+public:
+   typedef void (*Task)(void* context, unsigned index);
+
+   explicit WorkerPool(unsigned threads);
+   ~WorkerPool();
+
+   unsigned threads() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+   // Returns once task(context, i) has completed for every i < count.
+   void run(Task task, void* context, unsigned count);
+
+   // Number of logical processors.
+   static unsigned hardwareThreads();
+
+private:
+#if defined(_WIN32)
+   static DWORD WINAPI workerMain(void* pool);
+#else
+   static void* workerMain(void* pool);
+#endif
+
+   void workerLoop();
+   void drain();
+
+   void lock();
+   void unlock();
+
+#if defined(_WIN32)
+   std::vector<HANDLE> m_workers;
+   CRITICAL_SECTION m_mutex;
+   CONDITION_VARIABLE m_wake;
+   CONDITION_VARIABLE m_done;
+#else
+   std::vector<pthread_t> m_workers;
+   pthread_mutex_t m_mutex;
+   pthread_cond_t m_wake;
+   pthread_cond_t m_done;
+#endif
+
+   Task m_task;
+   void* m_context;
+   unsigned m_count;
+   volatile long m_next;
+   unsigned m_busy;
+   unsigned m_generation;
+   bool m_stopping;
+};
+
+/**
+  Blocks each of a fixed number of threads in wait() until all of them have
+  arrived, so that they start a measurement together. Single use.
+*/
+class ThreadBarrier
+{
+public:
+   explicit ThreadBarrier(unsigned threads);
+   ~ThreadBarrier();
+
+   void wait();
+
+private:
+#if defined(_WIN32)
+   CRITICAL_SECTION m_mutex;
+   CONDITION_VARIABLE m_released;
+#else
+   pthread_mutex_t m_mutex;
+   pthread_cond_t m_released;
+#endif
+
+   unsigned m_waiting;
+};
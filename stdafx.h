@@ -17,5 +17,10 @@
 #include <memory.h>
 #include <tchar.h>
 
+// Visual C++ 2010 only provides the non-standard spelling.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define snprintf _snprintf
+#endif
+
 
 // TODO: reference additional headers your program requires here